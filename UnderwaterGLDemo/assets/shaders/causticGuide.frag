@@ -0,0 +1,12 @@
+#version 430 core
+out vec4 oGuide;
+
+in vec3 world;
+in vec3 view;
+in vec3 normal;
+
+// top-down receiver normal and height for the caustic denoiser, texels without a receiver stay cleared to zero
+void main()
+{
+    oGuide = vec4(normalize(normal), world.y);
+}
\ No newline at end of file
@@ -0,0 +1,10 @@
+#version 430 core
+out vec4 oColor;
+
+flat in float irradiance;
+
+void main()
+{
+    // blended additively, overlapping triangles are light focused from different parts of the surface
+    oColor = vec4(irradiance, 0, 0, 1);
+}
\ No newline at end of file
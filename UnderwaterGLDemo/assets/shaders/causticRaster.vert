@@ -0,0 +1,54 @@
+#version 430 core
+#extension GL_ARB_shading_language_include : require
+
+#include "/surface.glsl"
+
+const float water_ior = 1.33f;
+
+uniform int gridCellCount; // in one dimension
+uniform bool useDisplacement;
+
+uniform vec3 lightPos;
+uniform vec3 lightDir; // cone axis
+uniform float lightCosCone;
+
+uniform float receiverHeight;
+uniform vec2 causticRegionMin;
+uniform float causticRegionSize;
+
+out vec3 vWaterPos;
+out vec3 vReceiverPos;
+out float vTransmittance; // zero outside the cone and for rays that don't reach the receiver
+
+void main()
+{
+    // same rows and patches as surfaceGridDisplace.vert
+    int row = gl_InstanceID % gridCellCount;
+    int patchId = gl_InstanceID / gridCellCount;
+    ivec2 cell = ivec2(row + 1 - gl_VertexID % 2, gl_VertexID / 2);
+
+    vec2 texCoord = vec2(cell) / gridCellCount;
+    vec2 position = texCoord - 0.5f;
+    vec3 surfacePos = useDisplacement ? getDisplacedPosition(position, texCoord) : getHeightPosition(position, texCoord);
+    vec2 patchShift = getPatchShift(patchId);
+    vWaterPos = (M * vec4(surfacePos.x + patchShift.x, surfacePos.y, surfacePos.z + patchShift.y, 1.0f)).xyz;
+
+    vec3 incident = normalize(vWaterPos - lightPos);
+    vec3 surfaceNormal = normalize(texture(normalTex, texCoord).rgb);
+    vec3 refracted = refract(incident, surfaceNormal, 1.0f / water_ior);
+
+    // Schlick, like the photon shade stage, except the flux is scaled instead of picking a side
+    float r0 = (1.0f - water_ior) / (1.0f + water_ior);
+    r0 *= r0;
+    vTransmittance = 1.0f - (r0 + (1.0f - r0) * pow(1.0f - abs(dot(incident, surfaceNormal)), 5.0f));
+    if (dot(incident, lightDir) < lightCosCone || dot(incident, surfaceNormal) >= 0.0f || refracted.y >= 0.0f)
+    {
+        vTransmittance = 0.0f;
+        refracted = vec3(0.0f, -1.0f, 0.0f);
+    }
+
+    float t = max((receiverHeight - vWaterPos.y) / refracted.y, 0.0f);
+    vReceiverPos = vWaterPos + t * refracted;
+    vec2 regionPos = (vReceiverPos.xz - causticRegionMin) / causticRegionSize;
+    gl_Position = vec4(2.0f * regionPos - 1.0f, 0.0f, 1.0f);
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+// lighting shared by the Phong fragment shaders, they only differ in where the caustics come from
+uniform vec3 ambientColor;
+uniform vec3 diffuseColor;
+uniform vec3 specularColor;
+uniform float specularHighlight;
+
+uniform vec3 lightPos;
+uniform vec3 lightCol;
+uniform vec3 lightDir; // cone axis
+uniform float lightCosCone;
+
+in vec3 world;
+in vec3 view;
+in vec3 normal;
+
+// causticIrradiance is from light that went through the water, it isn't shadowed by the cone
+vec3 getPhongColor(float causticIrradiance)
+{
+    float ambientLightLevel = 0.3f;
+
+    vec3 col = ambientLightLevel * ambientColor;
+
+    vec3 light = normalize(lightPos - world);
+    vec3 directCol = dot(-light, lightDir) >= lightCosCone ? lightCol : vec3(0);
+    col += ambientColor * diffuseColor * directCol * clamp(dot(normal, light), 0, 1);
+    col += ambientColor * diffuseColor * lightCol * causticIrradiance;
+
+    vec3 halfVec = normalize(view + light);
+    float nh = clamp(pow(dot(normal, halfVec), specularHighlight), 0, 1);
+    col += specularColor * directCol * nh;
+
+    return col;
+}
\ No newline at end of file
@@ -0,0 +1,151 @@
+// caustic photons hashed into a grid of cells, see PhotonHashGrid, bindings 16-18
+// cells are sorted by counting sort, so a cell's photons are contiguous between two entries of photonCellStarts
+const uint photon_hash_visited_max = 8u; // a query spans at most two cells per axis
+const uint photon_knn_max = 32u;
+
+// std430 layout shared with PhotonHashGrid.h
+struct StoredPhoton
+{
+	vec3 position;
+	float flux; // fraction of one emitted photon's flux
+	vec3 direction; // incoming
+	uint padding;
+};
+
+layout (std430, binding = 16) buffer PhotonMapBuffer
+{
+	uint storedPhotonCount; // can run past the capacity, readers clamp it
+	uint photonMapPadding0, photonMapPadding1, photonMapPadding2;
+	StoredPhoton storedPhotons[]; // in deposit order, written by the shade stage
+};
+layout (std430, binding = 17) buffer PhotonCellBuffer
+{
+	uint photonCellStarts[]; // one per hash slot plus the total
+};
+layout (std430, binding = 18) buffer SortedPhotonBuffer
+{
+	StoredPhoton sortedPhotons[];
+};
+
+uniform float photonHashCellSize;
+uniform uint photonHashTableMask;
+
+uint getStoredPhotonCount()
+{
+	return min(storedPhotonCount, uint(storedPhotons.length()));
+}
+
+ivec3 getPhotonCell(vec3 position)
+{
+	return ivec3(floor(position / photonHashCellSize));
+}
+
+// Teschner et al., "Optimized Spatial Hashing for Collision Detection of Deformable Objects"
+uint getPhotonHashSlot(ivec3 cell)
+{
+	uvec3 c = uvec3(cell);
+	return ((c.x * 73856093u) ^ (c.y * 19349663u) ^ (c.z * 83492791u)) & photonHashTableMask;
+}
+
+// flux of the photons within radius that arrived on the front side of normal, radius is clamped to half a cell
+float gatherPhotonFlux(vec3 position, vec3 normal, inout float radius, out uint photonCount)
+{
+	radius = min(radius, 0.5f * photonHashCellSize);
+	float radiusSq = radius * radius;
+	ivec3 cellMin = getPhotonCell(position - radius), cellMax = getPhotonCell(position + radius);
+	// at exactly half a cell, rounding can reach a third cell, which would overflow visited
+	cellMax = min(cellMax, cellMin + 1);
+
+	// neighbouring cells can share a slot, every slot is walked once
+	uint visited[photon_hash_visited_max];
+	uint visitedCount = 0u;
+	float flux = 0.0f;
+	photonCount = 0u;
+	for (int z = cellMin.z; z <= cellMax.z; z++)
+	for (int y = cellMin.y; y <= cellMax.y; y++)
+	for (int x = cellMin.x; x <= cellMax.x; x++)
+	{
+		uint slot = getPhotonHashSlot(ivec3(x, y, z));
+		bool seen = false;
+		for (uint i = 0u; i < visitedCount; i++)
+			seen = seen || visited[i] == slot;
+		if (seen)
+			continue;
+		visited[visitedCount++] = slot;
+
+		for (uint i = photonCellStarts[slot]; i < photonCellStarts[slot + 1u]; i++)
+		{
+			StoredPhoton photon = sortedPhotons[i];
+			vec3 offset = photon.position - position;
+			if (dot(offset, offset) <= radiusSq && dot(photon.direction, normal) < 0.0f)
+			{
+				flux += photon.flux;
+				photonCount++;
+			}
+		}
+	}
+	return flux;
+}
+
+// flux of the k nearest photons within maxRadius, radius is set to the distance of the farthest one
+// with fewer than k photons in range it stays at maxRadius, which keeps sparse regions dark instead of blown up
+float gatherNearestPhotonFlux(vec3 position, vec3 normal, uint k, float maxRadius, out float radius)
+{
+	k = clamp(k, 1u, photon_knn_max);
+	radius = min(maxRadius, 0.5f * photonHashCellSize);
+	ivec3 cellMin = getPhotonCell(position - radius), cellMax = getPhotonCell(position + radius);
+	// at exactly half a cell, rounding can reach a third cell, which would overflow visited
+	cellMax = min(cellMax, cellMin + 1);
+
+	// insertion sorted by distance
+	float nearestDistSq[photon_knn_max];
+	float nearestFlux[photon_knn_max];
+	uint nearestCount = 0u;
+	float maxDistSq = radius * radius;
+
+	uint visited[photon_hash_visited_max];
+	uint visitedCount = 0u;
+	for (int z = cellMin.z; z <= cellMax.z; z++)
+	for (int y = cellMin.y; y <= cellMax.y; y++)
+	for (int x = cellMin.x; x <= cellMax.x; x++)
+	{
+		uint slot = getPhotonHashSlot(ivec3(x, y, z));
+		bool seen = false;
+		for (uint i = 0u; i < visitedCount; i++)
+			seen = seen || visited[i] == slot;
+		if (seen)
+			continue;
+		visited[visitedCount++] = slot;
+
+		for (uint i = photonCellStarts[slot]; i < photonCellStarts[slot + 1u]; i++)
+		{
+			StoredPhoton photon = sortedPhotons[i];
+			vec3 offset = photon.position - position;
+			float distSq = dot(offset, offset);
+			if (distSq > maxDistSq || dot(photon.direction, normal) >= 0.0f)
+				continue;
+
+			uint j = min(nearestCount, k - 1u);
+			if (nearestCount == k && distSq >= nearestDistSq[j])
+				continue;
+			for (; j > 0u && nearestDistSq[j - 1u] > distSq; j--)
+			{
+				nearestDistSq[j] = nearestDistSq[j - 1u];
+				nearestFlux[j] = nearestFlux[j - 1u];
+			}
+			nearestDistSq[j] = distSq;
+			nearestFlux[j] = photon.flux;
+			nearestCount = min(nearestCount + 1u, k);
+			// once k are found only closer photons matter
+			if (nearestCount == k)
+				maxDistSq = nearestDistSq[k - 1u];
+		}
+	}
+
+	float flux = 0.0f;
+	for (uint i = 0u; i < nearestCount; i++)
+		flux += nearestFlux[i];
+	if (nearestCount == k)
+		radius = sqrt(nearestDistSq[k - 1u]);
+	return flux;
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+// ray queues of the wavefront photon stages, see PhotonTracer
+const uint photon_work_group_size = 64u;
+const uint photon_through_water = 1u; // flag, the path has crossed the water surface
+
+uniform uint photonRayOffset; // first ray of a sub-dispatch, zero for the indirect ones
+
+// std430 layout shared with PhotonTracer.h
+struct PhotonRay
+{
+	vec3 origin;
+	float flux; // fraction of one emitted photon's flux
+	vec3 direction;
+	uint photonId; // emission index, also the point mesh slot
+	uint depth; // surface interactions so far
+	uint flags;
+	uint padding0, padding1;
+};
+
+struct PhotonHit
+{
+	vec3 normal; // world space, unnormalized, zero for the water
+	float t; // negative on a miss
+	uint blas;
+	uint padding0, padding1, padding2;
+};
+
+layout (std430, binding = 12) buffer InRayBuffer
+{
+	PhotonRay inRays[];
+};
+layout (std430, binding = 13) buffer OutRayBuffer
+{
+	PhotonRay outRays[]; // survivors of the current bounce
+};
+layout (std430, binding = 14) buffer HitBuffer
+{
+	PhotonHit hits[]; // one per inRays entry
+};
+layout (std430, binding = 15) buffer QueueStateBuffer
+{
+	uint dispatchX, dispatchY, dispatchZ; // glDispatchComputeIndirect arguments for the next stage over inRays
+	uint inRayCount;
+	uint outRayCount;
+};
\ No newline at end of file
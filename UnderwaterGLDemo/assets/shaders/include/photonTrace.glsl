@@ -0,0 +1,559 @@
+// scene and water intersection shared by the photon stages, bindings 1-5 and 7-11
+const float pi = 3.14159265359f;
+const float box_margin = 0.0001f;
+const float t_offset = 0.0001f;
+const float eps = 1e-7f;
+const int max_march_steps = 1024;
+const float cell_nudge = 1e-3f; // in texels, keeps the current cell lookup off the boundary just crossed
+const int lbvh_stack_size = 64; // 32 key bits plus the index bits that split equal keys
+const float water_ior = 1.33f;
+
+const int surface_intersection_triangles = 0;
+const int surface_intersection_march = 1;
+const int surface_intersection_lbvh = 2;
+
+const uint blas_scene = 0u;
+const uint blas_water = 1u;
+
+const int heightfield_miss = 0; // something closer was hit first, or the ray went below every receiver
+const int heightfield_hit = 1;
+const int heightfield_outside = 2; // left the region or started below it, only the full trace can tell
+
+// first corner and both edges, so a test needs no index or vertex fetches
+struct InTriangle
+{
+	vec4 v0;
+	vec4 edge1;
+	vec4 edge2;
+};
+struct InModelInfo
+{
+	uint indexOffset, indexCount;
+	float minX, maxX;
+	float minY, maxY;
+	float minZ, maxZ;
+};
+
+struct InBvhNode
+{
+	float minX, minY, minZ;
+	float maxX, maxY, maxZ;
+	uint missIndex; // next node after skipping or finishing this subtree
+	uint triangleOffset; // first triangle for leaves, right child for inner nodes
+	uint triangleCount; // 0 for inner nodes, their left child follows directly
+};
+
+struct InLbvhNode
+{
+	float minX, minY, minZ;
+	float maxX, maxY, maxZ;
+	uint left, right; // leaves keep their triangle and its chunk's vertexOffset here
+	uint parent;
+};
+
+// rays are moved into object space once per instance, so no vertex is ever transformed
+struct InBvhInstance
+{
+	mat4 objectToWorld;
+	mat4 worldToObject;
+	uint blas; // one of blas_*
+	uint padding0, padding1, padding2;
+};
+
+struct InSurfaceChunkInfo
+{
+	uint vertexOffset, vertexCount;
+	uint indexOffset, indexCount;
+	float minX, maxX;
+	float minY, maxY;
+	float minZ, maxZ;
+	float marginX, marginZ;
+};
+
+layout (std430, binding = 1) buffer InTriangleBuffer
+{
+	InTriangle inTriangles[]; // in model order, a model's triangles start at indexOffset / 3
+};
+layout (std430, binding = 2) buffer InModelBuffer
+{
+	InModelInfo inModels[];
+};
+
+uniform mat4 surfaceM;
+uniform sampler2D surfaceDisplacementTex;
+uniform sampler2D surfaceNormalTex;
+uniform int surfacePatchCount; // in one dimension
+// one of surface_intersection_*, the march ignores horizontal displacement
+uniform int surfaceIntersection;
+uniform sampler2D surfaceHeightPyramidTex;
+uniform int surfaceHeightPyramidLevelCount;
+uniform uint surfaceBvhLeafOffset;
+
+layout (std430, binding = 3) buffer InSurfaceVertexBuffer
+{
+	vec4 inSurfaceVertices[]; // displaced world space positions of the patch at the origin
+};
+layout (std430, binding = 4) buffer InSurfaceIndexBuffer
+{
+	uint inSurfaceIndices[]; // 16-bit, two per element
+};
+layout (std430, binding = 5) buffer InSurfaceChunkBuffer
+{
+	InSurfaceChunkInfo inSurfaceChunks[];
+};
+
+uniform bool useSceneBvh;
+layout (std430, binding = 7) buffer InBvhNodeBuffer
+{
+	InBvhNode inBvhNodes[];
+};
+layout (std430, binding = 8) buffer InBvhTriangleBuffer
+{
+	InTriangle inBvhTriangles[]; // in leaf order
+};
+layout (std430, binding = 9) buffer InSurfaceBvhBuffer
+{
+	InLbvhNode inSurfaceBvhNodes[]; // refit to inSurfaceVertices every frame
+};
+layout (std430, binding = 10) buffer InTlasNodeBuffer
+{
+	InBvhNode inTlasNodes[]; // leaves hold instances instead of triangles
+};
+layout (std430, binding = 11) buffer InInstanceBuffer
+{
+	InBvhInstance inInstances[]; // in leaf order
+};
+
+// receivers seen from above, normal in rgb and world height in a, see SceneHeightfield
+uniform bool useSceneHeightfield;
+uniform sampler2D sceneHeightfieldTex;
+uniform vec2 sceneHeightfieldMin;
+uniform float sceneHeightfieldSize;
+uniform float sceneHeightfieldMinHeight; // lowest point of all scene copies, inside the region or not
+
+uint getSurfaceVertexIndex(uint index, uint vertexOffset)
+{
+	// indices are relative to the chunk's first vertex
+	uint packedIndices = inSurfaceIndices[index / 2u];
+	return vertexOffset + ((packedIndices >> (16u * (index % 2u))) & 0xFFFFu);
+}
+
+bool intersectTriangleEdges(vec3 rayOrigin, vec3 rayDir, vec3 v0, vec3 edge1, vec3 edge2, out float t)
+{
+	// https://en.wikipedia.org/wiki/M%C3%B6ller%E2%80%93Trumbore_intersection_algorithm
+	t = 0.0f;
+	
+	vec3 h = cross(rayDir, edge2);
+	float a = dot(edge1, h);
+	if (abs(a) < eps)
+		return false; // ray parallel to triangle
+
+	float f = 1.0f / a;
+	vec3 s = rayOrigin - v0;
+	float u = f * dot(s, h);
+	if (u < 0.0f || u > 1.0f)
+		return false;
+	vec3 q = cross(s, edge1);
+	float v = f * dot(rayDir, q);
+	if (v < 0.0f || u + v > 1.0f)
+		return false;
+
+	t = f * dot(edge2, q);
+	if (t > eps)
+		return true; // ray intersection
+	return false; // line intersection, but no ray intersection
+}
+
+bool intersectTriangle(vec3 rayOrigin, vec3 rayDir, vec3 v0, vec3 v1, vec3 v2, out float t)
+{
+	return intersectTriangleEdges(rayOrigin, rayDir, v0, v1 - v0, v2 - v0, t);
+}
+
+bool intersectBox(vec3 rayOrigin, vec3 rayDir, vec3 rayDirInv, vec3 minCorner, vec3 maxCorner)
+{
+	// https://tavianator.com/2011/ray_box.html
+	minCorner -= box_margin;
+	maxCorner += box_margin;
+	
+	float tx1 = (minCorner.x - rayOrigin.x) * rayDirInv.x;
+    float tx2 = (maxCorner.x - rayOrigin.x) * rayDirInv.x;
+
+    float tmin = min(tx1, tx2);
+    float tmax = max(tx1, tx2);
+
+    float ty1 = (minCorner.y - rayOrigin.y) * rayDirInv.y;
+    float ty2 = (maxCorner.y - rayOrigin.y) * rayDirInv.y;
+
+    tmin = max(tmin, min(ty1, ty2));
+    tmax = min(tmax, max(ty1, ty2));
+
+	float tz1 = (minCorner.z - rayOrigin.z) * rayDirInv.z;
+    float tz2 = (maxCorner.z - rayOrigin.z) * rayDirInv.z;
+
+	tmin = max(tmin, min(tz1, tz2));
+    tmax = min(tmax, max(tz1, tz2));
+
+    return tmax >= 0 && tmax >= tmin;
+}
+
+// like intersectBox, but also rejects boxes entered after tMax
+bool intersectBoxBefore(vec3 rayOrigin, vec3 rayDirInv, vec3 minCorner, vec3 maxCorner, float tMax)
+{
+	vec3 t1 = (minCorner - box_margin - rayOrigin) * rayDirInv;
+	vec3 t2 = (maxCorner + box_margin - rayOrigin) * rayDirInv;
+	vec3 tNear = min(t1, t2), tFar = max(t1, t2);
+	float tmin = max(max(tNear.x, tNear.y), tNear.z);
+	float tmax = min(min(tFar.x, tFar.y), tFar.z);
+	return tmax >= 0 && tmax >= tmin && tmin <= tMax;
+}
+
+// stackless, the miss links already encode where to go after every subtree
+// the ray is in model space, tHit is shared with world space since the direction isn't normalized again
+// hitNormal gets the unnormalized geometric normal of the closest triangle, also in model space
+bool intersectSceneBvh(vec3 origin, vec3 dir, vec3 dirInv, inout float tHit, inout vec3 hitNormal)
+{
+	bool found = false;
+	float t = 0.0f;
+	uint nodeIndex = 0;
+	uint nodeCount = inBvhNodes.length();
+	while (nodeIndex < nodeCount)
+	{
+		InBvhNode node = inBvhNodes[nodeIndex];
+		vec3 minCorner = vec3(node.minX, node.minY, node.minZ), maxCorner = vec3(node.maxX, node.maxY, node.maxZ);
+		if (!intersectBoxBefore(origin, dirInv, minCorner, maxCorner, tHit))
+		{
+			nodeIndex = node.missIndex;
+			continue;
+		}
+		if (node.triangleCount == 0)
+		{
+			nodeIndex++;
+			continue;
+		}
+
+		for (uint i = node.triangleOffset; i < node.triangleOffset + node.triangleCount; i++)
+		{
+			InTriangle triangle = inBvhTriangles[i];
+			if (intersectTriangleEdges(origin, dir, triangle.v0.xyz, triangle.edge1.xyz, triangle.edge2.xyz, t) && t < tHit)
+			{
+				found = true;
+				tHit = t;
+				hitNormal = cross(triangle.edge1.xyz, triangle.edge2.xyz);
+			}
+		}
+		nodeIndex = node.missIndex;
+	}
+	return found;
+}
+
+// every model's box and then all of its triangles, in model space like intersectSceneBvh
+bool intersectSceneMesh(vec3 origin, vec3 dir, vec3 dirInv, inout float tHit, inout vec3 hitNormal)
+{
+	bool found = false;
+	float t = 0.0f;
+	for (uint i = 0; i < inModels.length(); i++)
+	{
+		InModelInfo curInfo = inModels[i];
+		vec3 minCorner = vec3(curInfo.minX, curInfo.minY, curInfo.minZ);
+		vec3 maxCorner = vec3(curInfo.maxX, curInfo.maxY, curInfo.maxZ);
+		if (!intersectBoxBefore(origin, dirInv, minCorner, maxCorner, tHit))
+			continue;
+
+		uint triangleOffset = curInfo.indexOffset / 3;
+		for (uint j = triangleOffset; j < triangleOffset + curInfo.indexCount / 3; j++)
+		{
+			InTriangle triangle = inTriangles[j];
+			if (intersectTriangleEdges(origin, dir, triangle.v0.xyz, triangle.edge1.xyz, triangle.edge2.xyz, t) && t < tHit)
+			{
+				found = true;
+				tHit = t;
+				hitNormal = cross(triangle.edge1.xyz, triangle.edge2.xyz);
+			}
+		}
+	}
+	return found;
+}
+
+bool intersectSurfaceMesh(vec3 rayOrigin, vec3 rayDir, vec3 rayDirInv, out float tHit)
+{
+	bool found = false;
+	float t = 0.0f;
+	tHit = 0.0f;
+	int patchCountHalfFloor = (surfacePatchCount - 1) / 2;
+	for (uint patchId = 0; patchId < surfacePatchCount * surfacePatchCount; patchId++)
+	{
+		// the patch offset moves the ray instead of the vertices
+		vec2 patchShift = (vec2(patchId % surfacePatchCount, patchId / surfacePatchCount) - patchCountHalfFloor);
+		vec3 patchRayOrigin = rayOrigin - (surfaceM * vec4(patchShift.x, 0.0f, patchShift.y, 0.0f)).xyz;
+		for (uint i = 0; i < inSurfaceChunks.length(); i++)
+		{
+			InSurfaceChunkInfo chunkInfo = inSurfaceChunks[i];
+			vec3 minCorner = (surfaceM * vec4(chunkInfo.minX - chunkInfo.marginX,
+											  chunkInfo.minY,
+											  chunkInfo.minZ - chunkInfo.marginZ, 1.0f)).xyz;
+			vec3 maxCorner = (surfaceM * vec4(chunkInfo.maxX + chunkInfo.marginX,
+											  chunkInfo.maxY,
+											  chunkInfo.maxZ + chunkInfo.marginZ, 1.0f)).xyz;
+			if (intersectBox(patchRayOrigin, rayDir, rayDirInv, minCorner, maxCorner))
+			{
+				for (uint j = 0; j < chunkInfo.indexCount; j += 3)
+				{
+					uint index = chunkInfo.indexOffset + j;
+					vec3 v0 = inSurfaceVertices[getSurfaceVertexIndex(index, chunkInfo.vertexOffset)].xyz;
+					vec3 v1 = inSurfaceVertices[getSurfaceVertexIndex(index + 1, chunkInfo.vertexOffset)].xyz;
+					vec3 v2 = inSurfaceVertices[getSurfaceVertexIndex(index + 2, chunkInfo.vertexOffset)].xyz;
+					if (intersectTriangle(patchRayOrigin, rayDir, v0, v1, v2, t))
+					{
+						if (!found || t < tHit)
+						{
+							found = true;
+							tHit = t;
+						}
+					}
+				}
+			}
+		}
+	}
+	return found;
+}
+
+// the patch at the origin, water instances bring the ray there
+bool intersectSurfaceBvh(vec3 origin, vec3 dir, vec3 dirInv, inout float tHit)
+{
+	bool found = false;
+	float t = 0.0f;
+	uint stack[lbvh_stack_size];
+	int stackSize = 0;
+	uint nodeIndex = 0;
+	while (true)
+	{
+		InLbvhNode node = inSurfaceBvhNodes[nodeIndex];
+		vec3 minCorner = vec3(node.minX, node.minY, node.minZ), maxCorner = vec3(node.maxX, node.maxY, node.maxZ);
+		if (intersectBoxBefore(origin, dirInv, minCorner, maxCorner, tHit))
+		{
+			if (nodeIndex < surfaceBvhLeafOffset)
+			{
+				stack[stackSize++] = node.right;
+				nodeIndex = node.left;
+				continue;
+			}
+
+			uint index = 3 * node.left;
+			vec3 v0 = inSurfaceVertices[getSurfaceVertexIndex(index, node.right)].xyz;
+			vec3 v1 = inSurfaceVertices[getSurfaceVertexIndex(index + 1, node.right)].xyz;
+			vec3 v2 = inSurfaceVertices[getSurfaceVertexIndex(index + 2, node.right)].xyz;
+			if (intersectTriangle(origin, dir, v0, v1, v2, t) && t < tHit)
+			{
+				found = true;
+				tHit = t;
+			}
+		}
+		if (stackSize == 0)
+			break;
+		nodeIndex = stack[--stackSize];
+	}
+	return found;
+}
+
+// top level, the same stackless walk as intersectSceneBvh with one BLAS traversal per instance in the leaves
+// hitNormal is in world space but not normalized, water hits leave it at zero and use getSurfaceNormal
+bool intersectInstances(vec3 rayOrigin, vec3 rayDir, vec3 rayDirInv, bool includeScene, bool includeWater, inout float tHit,
+						inout uint hitBlas, inout vec3 hitNormal)
+{
+	bool found = false;
+	uint nodeIndex = 0;
+	uint nodeCount = inTlasNodes.length();
+	while (nodeIndex < nodeCount)
+	{
+		InBvhNode node = inTlasNodes[nodeIndex];
+		vec3 minCorner = vec3(node.minX, node.minY, node.minZ), maxCorner = vec3(node.maxX, node.maxY, node.maxZ);
+		if (!intersectBoxBefore(rayOrigin, rayDirInv, minCorner, maxCorner, tHit))
+		{
+			nodeIndex = node.missIndex;
+			continue;
+		}
+		if (node.triangleCount == 0)
+		{
+			nodeIndex++;
+			continue;
+		}
+
+		for (uint i = node.triangleOffset; i < node.triangleOffset + node.triangleCount; i++)
+		{
+			uint blas = inInstances[i].blas;
+			if (blas == blas_scene && !includeScene)
+				continue;
+			// the other water modes handle every patch on their own
+			if (blas == blas_water && (!includeWater || surfaceIntersection != surface_intersection_lbvh))
+				continue;
+
+			mat4 worldToObject = inInstances[i].worldToObject;
+			vec3 origin = (worldToObject * vec4(rayOrigin, 1.0f)).xyz;
+			vec3 dir = (worldToObject * vec4(rayDir, 0.0f)).xyz;
+			vec3 dirInv = 1.0f / dir;
+			bool instanceFound;
+			vec3 objectNormal = vec3(0.0f);
+			if (blas == blas_water)
+				instanceFound = intersectSurfaceBvh(origin, dir, dirInv, tHit);
+			else if (useSceneBvh)
+				instanceFound = intersectSceneBvh(origin, dir, dirInv, tHit, objectNormal);
+			else
+				instanceFound = intersectSceneMesh(origin, dir, dirInv, tHit, objectNormal);
+			if (instanceFound)
+			{
+				found = true;
+				hitBlas = blas;
+				// normals go back with the inverse transpose
+				hitNormal = transpose(mat3(worldToObject)) * objectNormal;
+			}
+		}
+		nodeIndex = node.missIndex;
+	}
+	return found;
+}
+
+float getSurfaceHeight(ivec2 texel, int size)
+{
+	return texelFetch(surfaceDisplacementTex, (texel % size + size) % size, 0).g;
+}
+
+// first t in [0, tMax] where the ray crosses the bilinear patch between four texel centres
+// cellPos is where the ray enters the cell, in [0, 1]^2 relative to the texel at cell
+bool intersectBilinearCell(ivec2 cell, int size, vec2 cellPos, float y, vec2 gridDir, float dirY, float tMax, out float tHit)
+{
+	tHit = 0.0f;
+	float h00 = getSurfaceHeight(cell, size), h10 = getSurfaceHeight(cell + ivec2(1, 0), size);
+	float h01 = getSurfaceHeight(cell + ivec2(0, 1), size), h11 = getSurfaceHeight(cell + ivec2(1, 1), size);
+	float hx = h10 - h00, hz = h01 - h00, hxz = h00 - h10 - h01 + h11;
+
+	// y(t) - h(t) is quadratic along the ray
+	float a = -hxz * gridDir.x * gridDir.y;
+	float b = dirY - (hx * gridDir.x + hz * gridDir.y + hxz * (cellPos.x * gridDir.y + cellPos.y * gridDir.x));
+	float c = y - (h00 + hx * cellPos.x + hz * cellPos.y + hxz * cellPos.x * cellPos.y);
+
+	if (abs(a) < eps)
+	{
+		if (abs(b) < eps)
+			return false; // parallel to a flat patch
+		tHit = -c / b;
+		return tHit >= 0.0f && tHit <= tMax;
+	}
+	float discriminant = b * b - 4.0f * a * c;
+	if (discriminant < 0.0f)
+		return false;
+	float sqrtDiscriminant = sqrt(discriminant);
+	float t1 = (-b - sqrtDiscriminant) / (2.0f * a), t2 = (-b + sqrtDiscriminant) / (2.0f * a);
+	float tNear = min(t1, t2), tFar = max(t1, t2);
+	tHit = tNear >= 0.0f ? tNear : tFar;
+	return tHit >= 0.0f && tHit <= tMax;
+}
+
+bool marchSurface(vec3 rayOrigin, vec3 rayDir, out float tHit)
+{
+	// surface space keeps the ray parameter, since the direction isn't normalized again
+	tHit = 0.0f;
+	mat4 surfaceInvM = inverse(surfaceM);
+	vec3 origin = (surfaceInvM * vec4(rayOrigin, 1.0f)).xyz;
+	vec3 dir = (surfaceInvM * vec4(rayDir, 0.0f)).xyz;
+
+	int topLevel = surfaceHeightPyramidLevelCount - 1;
+	vec4 topBounds = texelFetch(surfaceHeightPyramidTex, ivec2(0), topLevel);
+	float halfExtent = 0.5f * surfacePatchCount;
+	vec3 dirInv = 1.0f / dir;
+	vec3 t1 = (vec3(-halfExtent, topBounds.x, -halfExtent) - origin) * dirInv;
+	vec3 t2 = (vec3(halfExtent, topBounds.y, halfExtent) - origin) * dirInv;
+	vec3 tSlabMin = min(t1, t2), tSlabMax = max(t1, t2);
+	float t = max(max(tSlabMin.x, tSlabMin.y), max(tSlabMin.z, 0.0f));
+	float tEnd = min(tSlabMax.x, min(tSlabMax.y, tSlabMax.z));
+
+	// texel centres sit on integer grid coordinates, every patch wraps onto the same texels
+	int size = textureSize(surfaceHeightPyramidTex, 0).x;
+	vec2 gridOrigin = (origin.xz + 0.5f) * size - 0.5f;
+	vec2 gridDir = dir.xz * size;
+	vec2 gridDirInv = 1.0f / gridDir;
+	vec2 gridNudge = sign(gridDir) * cell_nudge;
+
+	int level = topLevel;
+	for (int i = 0; i < max_march_steps && t <= tEnd; i++)
+	{
+		float cellSize = float(1 << level);
+		vec2 gridPos = gridOrigin + t * gridDir;
+		vec2 cell = floor((gridPos + gridNudge) / cellSize);
+		vec2 tBoundary = ((cell + step(0.0f, gridDir)) * cellSize - gridOrigin) * gridDirInv;
+		float tCellEnd = min(min(tBoundary.x, tBoundary.y), tEnd);
+
+		int levelSize = size >> level;
+		ivec2 texel = (ivec2(cell) % levelSize + levelSize) % levelSize;
+		vec4 bounds = texelFetch(surfaceHeightPyramidTex, texel, level);
+		float yStart = origin.y + t * dir.y, yEnd = origin.y + tCellEnd * dir.y;
+		if (min(yStart, yEnd) <= bounds.y && max(yStart, yEnd) >= bounds.x)
+		{
+			if (level > 0)
+			{
+				level--;
+				continue;
+			}
+			float tCell;
+			if (intersectBilinearCell(ivec2(cell), size, gridPos - cell, yStart, gridDir, dir.y, tCellEnd - t, tCell))
+			{
+				tHit = t + tCell;
+				return true;
+			}
+		}
+		else if (level < topLevel)
+		{
+			// missed cells are usually followed by more misses
+			level++;
+		}
+		t = tCellEnd;
+	}
+	return false;
+}
+
+vec3 getSurfaceNormal(vec3 worldPos)
+{
+	// the patch is a unit square in surface space, texture coordinates wrap with it
+	vec2 surfacePos = (inverse(surfaceM) * vec4(worldPos, 1.0f)).xz;
+	return normalize(textureLod(surfaceNormalTex, fract(surfacePos + 0.5f), 0.0f).rgb);
+}
+
+// steps of at most a texel along the ray until it drops below the stored height, one of heightfield_*
+// walls only show up as their top texels, so this is for rays going down onto the receivers
+int marchSceneHeightfield(vec3 rayOrigin, vec3 rayDir, float tMax, out float tHit, out vec3 hitNormal)
+{
+	tHit = 0.0f;
+	hitNormal = vec3(0.0f);
+	int size = textureSize(sceneHeightfieldTex, 0).x;
+	float texelSize = sceneHeightfieldSize / size;
+	float dt = texelSize / max(length(rayDir.xz), abs(rayDir.y));
+
+	float prevT = 0.0f, prevAbove = 0.0f;
+	for (int i = 0; i < max_march_steps; i++)
+	{
+		float t = i * dt;
+		if (t > tMax)
+			return heightfield_miss;
+		vec3 pos = rayOrigin + t * rayDir;
+		// empty columns would otherwise be marched to the end, the ray is going down and can't hit anything from here
+		if (pos.y < sceneHeightfieldMinHeight)
+			return heightfield_miss;
+		vec2 regionPos = (pos.xz - sceneHeightfieldMin) / sceneHeightfieldSize;
+		if (any(lessThan(regionPos, vec2(0.0f))) || any(greaterThanEqual(regionPos, vec2(1.0f))))
+			return heightfield_outside;
+
+		vec4 texel = texelFetch(sceneHeightfieldTex, ivec2(regionPos * size), 0);
+		float above = pos.y - texel.a;
+		if (above <= 0.0f)
+		{
+			if (i == 0)
+				return heightfield_outside;
+			// the crossing between the last two samples, assuming the height is linear in between
+			tHit = min(mix(prevT, t, prevAbove / (prevAbove - above)), tMax);
+			hitNormal = texel.rgb;
+			return heightfield_hit;
+		}
+		prevT = t;
+		prevAbove = above;
+	}
+	return heightfield_outside;
+}
\ No newline at end of file
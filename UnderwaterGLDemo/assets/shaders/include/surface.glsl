@@ -0,0 +1,44 @@
+uniform mat4 M;
+uniform mat4 V, invV;
+uniform mat4 P;
+
+uniform sampler2D displacementTex;
+uniform sampler2D normalTex;
+uniform int patchCount; // in one dimension
+
+out vec3 world;
+out vec3 view;
+out vec3 normal;
+
+vec2 getPatchShift(int patchId)
+{
+    int patchCountHalfFloor = (patchCount - 1) / 2;
+    return vec2(patchId % patchCount, patchId / patchCount) - patchCountHalfFloor;
+}
+
+vec3 getHeightPosition(vec2 position, vec2 texCoord)
+{
+    return vec3(position.x, texture(displacementTex, texCoord).g, position.y);
+}
+
+vec3 getDisplacedPosition(vec2 position, vec2 texCoord)
+{
+    return vec3(position.x, 0.0f, position.y) + texture(displacementTex, texCoord).rgb;
+}
+
+void emitWorldSurfaceVertex(vec4 worldPos, vec2 texCoord)
+{
+    normal = texture(normalTex, texCoord).rgb;
+
+    world = worldPos.xyz;
+    vec3 camPos = (invV * vec4(0.0f, 0.0f, 0.0f, 1.0f)).xyz;
+    view = normalize(camPos - worldPos.xyz);
+
+    gl_Position = P * V * worldPos;
+}
+
+void emitSurfaceVertex(vec3 surfacePos, vec2 texCoord, vec2 patchShift)
+{
+    vec4 shiftedPos = vec4(surfacePos.x + patchShift.x, surfacePos.y, surfacePos.z + patchShift.y, 1.0f);
+    emitWorldSurfaceVertex(M * shiftedPos, texCoord);
+}
\ No newline at end of file
@@ -1,30 +1,31 @@
 #version 430 core
+#extension GL_ARB_shading_language_include : require
 out vec4 oColor;
 
-uniform vec3 ambientColor;
-uniform vec3 diffuseColor;
-uniform vec3 specularColor;
-uniform float specularHighlight;
+#include "/phong.glsl"
 
-in vec3 world;
-in vec3 view;
-in vec3 normal;
+// irradiance from photons that went through the water, top-down over a square XZ region
+uniform bool useCaustics;
+uniform sampler2D causticTex;
+uniform vec2 causticRegionMin;
+uniform float causticRegionSize;
+// top-down receiver normal and height over the same region, see SceneHeightfield
+uniform sampler2D causticReceiverTex;
 
 void main()
 {
-    // TODO: light uniforms
-    vec3 lightPos = vec3(0, 10, 0);
-    vec3 lightCol = vec3(1);
-    float ambientLightLevel = 0.3f;
+    float caustic = 0.0f;
+    vec2 causticPos = (world.xz - causticRegionMin) / causticRegionSize;
+    if (useCaustics && all(greaterThanEqual(causticPos, vec2(0))) && all(lessThan(causticPos, vec2(1))))
+    {
+        // a texel only holds light for the highest receiver above it, anything below is in its shadow
+        int receiverSize = textureSize(causticReceiverTex, 0).x;
+        float receiverHeight = texelFetch(causticReceiverTex, ivec2(causticPos * receiverSize), 0).a;
+        float tolerance = 2.0f * causticRegionSize / receiverSize;
+        float receiverWeight = 1.0f - smoothstep(tolerance, 2.0f * tolerance, abs(world.y - receiverHeight));
+        // the map is flux over horizontal area, a tilted surface spreads it over 1 / normal.y as much
+        caustic = texture(causticTex, causticPos).r * receiverWeight * max(normalize(normal).y, 0.0f);
+    }
 
-    vec3 col = ambientLightLevel * ambientColor;
-
-    vec3 light = normalize(lightPos - world);
-    col += ambientColor * diffuseColor * lightCol * clamp(dot(normal, light), 0, 1);
-
-    vec3 halfVec = normalize(view + light);
-    float nh = clamp(pow(dot(normal, halfVec), specularHighlight), 0, 1);
-    col += specularColor * lightCol * nh;
-
-    oColor = vec4(col, 1);
+    oColor = vec4(getPhongColor(caustic), 1);
 }
\ No newline at end of file
@@ -0,0 +1,32 @@
+#version 430 core
+#extension GL_ARB_shading_language_include : require
+out vec4 oColor;
+
+#include "/phong.glsl"
+#include "/photonHash.glsl"
+
+// caustics estimated from this frame's photons around the fragment, instead of the splatted map
+uniform uint photonDensityNearest; // 0 gathers everything within the radius
+uniform float photonDensityRadius;
+uniform float photonFlux; // of one emitted photon
+
+const float pi = 3.14159265359f;
+
+void main()
+{
+    vec3 n = normalize(normal);
+    float radius = photonDensityRadius;
+    float flux;
+    if (photonDensityNearest == 0u)
+    {
+        uint photonCount;
+        flux = gatherPhotonFlux(world, n, radius, photonCount);
+    }
+    else
+    {
+        flux = gatherNearestPhotonFlux(world, n, photonDensityNearest, photonDensityRadius, radius);
+    }
+    radius = max(radius, 1e-3f);
+
+    oColor = vec4(getPhongColor(flux * photonFlux / (pi * radius * radius)), 1);
+}
\ No newline at end of file
@@ -0,0 +1,17 @@
+#version 430 core
+#extension GL_ARB_shading_language_include : require
+layout (location = 1) in vec2 texCoord;
+
+layout (std430, binding = 0) buffer DisplacedVertexBuffer
+{
+	vec4 displacedVertices[];
+};
+
+#include "/surface.glsl"
+
+void main()
+{
+    // gl_VertexID includes the chunk's base vertex, other patches are a world-space offset away
+    vec2 patchShift = getPatchShift(gl_InstanceID);
+    emitWorldSurfaceVertex(displacedVertices[gl_VertexID] + M * vec4(patchShift.x, 0.0f, patchShift.y, 0.0f), texCoord);
+}
\ No newline at end of file
@@ -0,0 +1,15 @@
+#version 430 core
+#extension GL_ARB_shading_language_include : require
+layout (location = 0) in vec2 position;
+layout (location = 1) in vec2 texCoord;
+layout (location = 2) in vec4 chunkOffset; // position offset, texCoord offset; advances once per patchCount^2 instances
+
+#include "/surface.glsl"
+
+void main()
+{
+    vec2 chunkPosition = position + chunkOffset.xy;
+    vec2 chunkTexCoord = texCoord + chunkOffset.zw;
+    int patchId = gl_InstanceID % (patchCount * patchCount);
+    emitSurfaceVertex(getHeightPosition(chunkPosition, chunkTexCoord), chunkTexCoord, getPatchShift(patchId));
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+#version 430 core
+#extension GL_ARB_shading_language_include : require
+
+#include "/surface.glsl"
+
+uniform int clipmapCellCount; // in one dimension, multiple of 4
+uniform int clipmapLevelCount;
+uniform float clipmapBaseCellSize;
+uniform vec2 clipmapCenter;
+
+// (1, 0), (0, 0), (1, 1) and (1, 1), (0, 0), (0, 1), same winding as Plane
+const ivec2 cellCorners[6] = ivec2[](ivec2(1, 0), ivec2(0, 0), ivec2(1, 1), ivec2(1, 1), ivec2(0, 0), ivec2(0, 1));
+
+vec2 getLevelOrigin(int level)
+{
+    float cellSize = clipmapBaseCellSize * exp2(level);
+    // snapping to the next coarser grid keeps every even vertex on the coarser level's vertices
+    vec2 center = floor(clipmapCenter / (2.0f * cellSize)) * (2.0f * cellSize);
+    return center - (clipmapCellCount / 2) * cellSize;
+}
+
+void main()
+{
+    int level = gl_InstanceID;
+    int cellId = gl_VertexID / 6;
+    ivec2 cell = ivec2(cellId / clipmapCellCount, cellId % clipmapCellCount);
+    ivec2 vertexIndex = cell + cellCorners[gl_VertexID % 6];
+
+    float cellSize = clipmapBaseCellSize * exp2(level);
+    vec2 origin = getLevelOrigin(level);
+
+    if (level > 0)
+    {
+        // the finer level fills this part, its bounds lie on this level's grid lines
+        vec2 holeMin = getLevelOrigin(level - 1);
+        vec2 holeMax = holeMin + (clipmapCellCount / 2) * cellSize;
+        vec2 cellCenter = origin + (vec2(cell) + 0.5f) * cellSize;
+        if (all(greaterThan(cellCenter, holeMin)) && all(lessThan(cellCenter, holeMax)))
+        {
+            world = view = normal = vec3(0.0f);
+            gl_Position = vec4(2.0f, 2.0f, 2.0f, 1.0f); // outside the clip volume
+            return;
+        }
+    }
+    if (level < clipmapLevelCount - 1)
+    {
+        // odd vertices on the outer edge collapse onto their even neighbours, so the edge matches the coarser level
+        if (vertexIndex.x == 0 || vertexIndex.x == clipmapCellCount)
+            vertexIndex.y -= vertexIndex.y % 2;
+        if (vertexIndex.y == 0 || vertexIndex.y == clipmapCellCount)
+            vertexIndex.x -= vertexIndex.x % 2;
+    }
+
+    vec2 position = origin + vec2(vertexIndex) * cellSize;
+    vec2 texCoord = position + 0.5f;
+    emitSurfaceVertex(getHeightPosition(position, texCoord), texCoord, vec2(0.0f));
+}
\ No newline at end of file
@@ -0,0 +1,17 @@
+#version 430 core
+#extension GL_ARB_shading_language_include : require
+layout (location = 1) in vec2 texCoord;
+layout (location = 2) in uint patchId; // instanced, offset by the draw command's baseInstance
+
+layout (std430, binding = 0) buffer DisplacedVertexBuffer
+{
+	vec4 displacedVertices[];
+};
+
+#include "/surface.glsl"
+
+void main()
+{
+    vec2 patchShift = getPatchShift(int(patchId));
+    emitWorldSurfaceVertex(displacedVertices[gl_VertexID] + M * vec4(patchShift.x, 0.0f, patchShift.y, 0.0f), texCoord);
+}
\ No newline at end of file
@@ -0,0 +1,12 @@
+#version 430 core
+#extension GL_ARB_shading_language_include : require
+layout (location = 0) in vec2 position;
+layout (location = 1) in vec2 texCoord;
+layout (location = 2) in uint patchId; // instanced, offset by the draw command's baseInstance
+
+#include "/surface.glsl"
+
+void main()
+{
+    emitSurfaceVertex(getHeightPosition(position, texCoord), texCoord, getPatchShift(int(patchId)));
+}
\ No newline at end of file
@@ -0,0 +1,18 @@
+#version 430 core
+#extension GL_ARB_shading_language_include : require
+
+#include "/surface.glsl"
+
+uniform int gridCellCount; // in one dimension
+
+void main()
+{
+    // one triangle strip per grid row, instances go through rows first and then patches
+    int row = gl_InstanceID % gridCellCount;
+    int patchId = gl_InstanceID / gridCellCount;
+    ivec2 cell = ivec2(row + 1 - gl_VertexID % 2, gl_VertexID / 2);
+
+    vec2 texCoord = vec2(cell) / gridCellCount;
+    vec2 position = texCoord - 0.5f;
+    emitSurfaceVertex(getDisplacedPosition(position, texCoord), texCoord, getPatchShift(patchId));
+}
\ No newline at end of file
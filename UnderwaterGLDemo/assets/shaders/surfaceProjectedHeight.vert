@@ -0,0 +1,34 @@
+#version 430 core
+#extension GL_ARB_shading_language_include : require
+
+#include "/surface.glsl"
+
+uniform mat4 invP;
+
+uniform int projectedGridWidth, projectedGridHeight; // vertices
+uniform float projectedGridMargin; // in NDC, hides the grid edge when waves lift it
+uniform float projectedGridMaxDistance; // in surface units
+uniform vec3 projectedGridCamera; // in surface units
+
+void main()
+{
+    // one triangle strip per grid row, same layout as surfaceGridHeight.vert
+    ivec2 index = ivec2(gl_VertexID / 2, gl_InstanceID + 1 - gl_VertexID % 2);
+    vec2 ndc = (vec2(index) / vec2(projectedGridWidth - 1, projectedGridHeight - 1) * 2.0f - 1.0f) * (1.0f + projectedGridMargin);
+
+    vec4 viewPoint = invP * vec4(ndc, 1.0f, 1.0f);
+    vec3 rayDir = (invV * vec4(viewPoint.xyz / viewPoint.w, 0.0f)).xyz;
+
+    // where the ray misses the plane (above the horizon) the vertex is pinned to the max distance
+    vec2 horizontalDir = normalize(rayDir.xz + vec2(1e-7f));
+    float horizontalDistance = projectedGridMaxDistance;
+    float t = -projectedGridCamera.y / rayDir.y;
+    if (t > 0.0f)
+    {
+        horizontalDistance = min(t * length(rayDir.xz), projectedGridMaxDistance);
+    }
+    vec2 position = projectedGridCamera.xz + horizontalDir * horizontalDistance;
+
+    vec2 texCoord = position + 0.5f;
+    emitSurfaceVertex(getHeightPosition(position, texCoord), texCoord, vec2(0.0f));
+}
\ No newline at end of file
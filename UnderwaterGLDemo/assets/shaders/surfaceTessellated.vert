@@ -0,0 +1,18 @@
+#version 430 core
+layout (location = 0) in vec2 position;
+layout (location = 1) in vec2 texCoord;
+
+uniform int patchCount; // in one dimension
+
+out vec2 tescPosition;
+out vec2 tescTexCoord;
+out vec2 tescPatchShift;
+
+void main()
+{
+    // surface.glsl declares the fragment outputs, so the patch shift is computed here by hand
+    int patchCountHalfFloor = (patchCount - 1) / 2;
+    tescPosition = position;
+    tescTexCoord = texCoord;
+    tescPatchShift = vec2(gl_InstanceID % patchCount, gl_InstanceID / patchCount) - patchCountHalfFloor;
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#include <algorithm>
+
+#include "BudgetedJob.h"
+
+BudgetedJob::BudgetedJob(float budgetMilliseconds, unsigned int maxChunkSize)
+	: chunkSize(MIN_CHUNK_SIZE), maxChunkSize(std::max(maxChunkSize, MIN_CHUNK_SIZE)), budgetMilliseconds(budgetMilliseconds)
+{
+}
+
+void BudgetedJob::Start(unsigned int newTotalWork)
+{
+	totalWork = newTotalWork;
+	doneWork = 0;
+	// the cost per item isn't known yet, the first chunks are small and grow from there
+	chunkSize = MIN_CHUNK_SIZE;
+}
+
+void BudgetedJob::Cancel()
+{
+	totalWork = doneWork;
+}
+
+void BudgetedJob::Step(const std::function<void(unsigned int, unsigned int)>& runChunk)
+{
+	if (!IsActive())
+		return;
+
+	unsigned int count = std::min(chunkSize, totalWork - doneWork);
+	timer.Begin();
+	runChunk(doneWork, count);
+	timer.End();
+	lastMilliseconds = timer.Wait();
+	doneWork += count;
+
+	// linear in the item count, the next chunk is whatever would have fit the budget
+	float scale = lastMilliseconds > 0.0f ? budgetMilliseconds / lastMilliseconds : MAX_GROWTH;
+	float nextChunkSize = count * std::clamp(scale, 1.0f / MAX_GROWTH, MAX_GROWTH);
+	chunkSize = (unsigned int)std::clamp(nextChunkSize, (float)MIN_CHUNK_SIZE, (float)maxChunkSize);
+}
\ No newline at end of file
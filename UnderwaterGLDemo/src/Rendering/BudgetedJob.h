@@ -0,0 +1,38 @@
+#pragma once
+
+#include <functional>
+
+#include "GpuTimer.h"
+
+// a long GPU job split into one chunk per frame, each chunk is sized from the GPU time of the previous one
+// so a bake of any size keeps the frame within the budget instead of stalling the UI or tripping the driver's watchdog
+class BudgetedJob
+{
+public:
+	static const unsigned int MIN_CHUNK_SIZE = 1024;
+	static constexpr float MAX_GROWTH = 2.0f; // per chunk, a cheap first chunk mustn't jump straight to a huge one
+
+private:
+	GpuTimer timer;
+	unsigned int totalWork = 0, doneWork = 0;
+	unsigned int chunkSize;
+	unsigned int maxChunkSize;
+	float lastMilliseconds = 0.0f;
+
+public:
+	float budgetMilliseconds;
+
+	BudgetedJob(float budgetMilliseconds, unsigned int maxChunkSize);
+	void Start(unsigned int newTotalWork);
+	void Cancel();
+	// runs the next chunk when the job is active and waits for its timer, which only costs about the budget
+	// runChunk gets the chunk's offset and size and can't use other GpuTimers
+	void Step(const std::function<void(unsigned int, unsigned int)>& runChunk);
+
+	inline bool IsActive() { return doneWork < totalWork; }
+	inline float GetProgress() { return totalWork == 0 ? 0.0f : (float)doneWork / totalWork; }
+	inline unsigned int GetDoneWork() { return doneWork; }
+	inline unsigned int GetTotalWork() { return totalWork; }
+	inline unsigned int GetChunkSize() { return chunkSize; }
+	inline float GetLastMilliseconds() { return lastMilliseconds; }
+};
\ No newline at end of file
@@ -0,0 +1,254 @@
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+
+#include "Bvh.h"
+
+namespace Bvh
+{
+	struct Bounds
+	{
+		glm::vec3 min{ FLT_MAX }, max{ -FLT_MAX };
+
+		inline void Grow(const glm::vec3& point)
+		{
+			min = glm::min(min, point);
+			max = glm::max(max, point);
+		}
+		inline void Grow(const Bounds& other)
+		{
+			min = glm::min(min, other.min);
+			max = glm::max(max, other.max);
+		}
+		inline float GetArea() const
+		{
+			glm::vec3 extent = max - min;
+			if (extent.x < 0.0f)
+				return 0.0f;
+			return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+		}
+	};
+
+	struct Bin
+	{
+		Bounds bounds;
+		unsigned int count = 0;
+	};
+
+	struct BuildContext
+	{
+		std::vector<Bounds> triangleBounds;
+		std::vector<glm::vec3> centroids;
+		std::vector<unsigned int> triangles; // reordered during the build
+		std::vector<Node>& nodes;
+		BuildStats& stats;
+		float rootArea = 0.0f;
+	};
+
+	int GetBin(float centroid, float min, float binScale)
+	{
+		return std::min(BIN_COUNT - 1, (int)((centroid - min) * binScale));
+	}
+
+	unsigned int MakeLeaf(BuildContext& context, unsigned int nodeIndex, unsigned int begin, unsigned int end, float area)
+	{
+		context.nodes[nodeIndex].triangleOffset = begin;
+		context.nodes[nodeIndex].triangleCount = end - begin;
+		context.stats.leafCount++;
+		context.stats.sahCost += (end - begin) * area / context.rootArea;
+		return nodeIndex;
+	}
+
+	unsigned int BuildNode(BuildContext& context, unsigned int begin, unsigned int end, unsigned int depth)
+	{
+		unsigned int nodeIndex = (unsigned int)context.nodes.size();
+		context.nodes.push_back(Node{});
+		context.stats.maxDepth = std::max(context.stats.maxDepth, depth);
+
+		Bounds bounds, centroidBounds;
+		for (unsigned int i = begin; i < end; i++)
+		{
+			unsigned int triangle = context.triangles[i];
+			bounds.Grow(context.triangleBounds[triangle]);
+			centroidBounds.Grow(context.centroids[triangle]);
+		}
+		Node& node = context.nodes[nodeIndex];
+		node.minX = bounds.min.x;
+		node.minY = bounds.min.y;
+		node.minZ = bounds.min.z;
+		node.maxX = bounds.max.x;
+		node.maxY = bounds.max.y;
+		node.maxZ = bounds.max.z;
+
+		unsigned int count = end - begin;
+		float area = bounds.GetArea();
+		if (depth == 0)
+			context.rootArea = std::max(area, FLT_MIN);
+		if (count == 1)
+			return MakeLeaf(context, nodeIndex, begin, end, area);
+
+		// every axis is binned by centroid, splits are only tried between bins
+		float bestCost = FLT_MAX;
+		int bestAxis = -1, bestSplit = 0;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			float extent = centroidBounds.max[axis] - centroidBounds.min[axis];
+			if (extent <= 0.0f)
+				continue;
+			float binScale = BIN_COUNT / extent;
+
+			Bin bins[BIN_COUNT];
+			for (unsigned int i = begin; i < end; i++)
+			{
+				unsigned int triangle = context.triangles[i];
+				Bin& bin = bins[GetBin(context.centroids[triangle][axis], centroidBounds.min[axis], binScale)];
+				bin.bounds.Grow(context.triangleBounds[triangle]);
+				bin.count++;
+			}
+
+			// split i puts bins [0, i] on the left
+			float leftCost[BIN_COUNT - 1];
+			Bounds leftBounds;
+			unsigned int leftCount = 0;
+			for (int i = 0; i < BIN_COUNT - 1; i++)
+			{
+				leftBounds.Grow(bins[i].bounds);
+				leftCount += bins[i].count;
+				leftCost[i] = leftBounds.GetArea() * leftCount;
+			}
+			Bounds rightBounds;
+			unsigned int rightCount = 0;
+			for (int i = BIN_COUNT - 1; i > 0; i--)
+			{
+				rightBounds.Grow(bins[i].bounds);
+				rightCount += bins[i].count;
+				float cost = TRAVERSAL_COST + (leftCost[i - 1] + rightBounds.GetArea() * rightCount) / std::max(area, FLT_MIN);
+				if (rightCount > 0 && rightCount < count && cost < bestCost)
+				{
+					bestCost = cost;
+					bestAxis = axis;
+					bestSplit = i - 1;
+				}
+			}
+		}
+
+		if (count <= MAX_LEAF_SIZE && (bestAxis < 0 || bestCost >= count))
+			return MakeLeaf(context, nodeIndex, begin, end, area);
+
+		unsigned int middle;
+		if (bestAxis < 0)
+		{
+			// all centroids in one point, any half works
+			middle = begin + count / 2;
+		}
+		else
+		{
+			float min = centroidBounds.min[bestAxis];
+			float binScale = BIN_COUNT / (centroidBounds.max[bestAxis] - min);
+			auto middleIt = std::partition(context.triangles.begin() + begin, context.triangles.begin() + end, [&](unsigned int triangle)
+			{
+				return GetBin(context.centroids[triangle][bestAxis], min, binScale) <= bestSplit;
+			});
+			middle = (unsigned int)(middleIt - context.triangles.begin());
+		}
+
+		context.stats.sahCost += TRAVERSAL_COST * area / context.rootArea;
+		BuildNode(context, begin, middle, depth + 1);
+		unsigned int rightChild = BuildNode(context, middle, end, depth + 1);
+		context.nodes[nodeIndex].triangleOffset = rightChild;
+		return nodeIndex;
+	}
+
+	void SetMissLinks(std::vector<Node>& nodes, unsigned int nodeIndex, unsigned int missIndex)
+	{
+		Node& node = nodes[nodeIndex];
+		node.missIndex = missIndex;
+		if (node.triangleCount == 0)
+		{
+			unsigned int rightChild = node.triangleOffset;
+			SetMissLinks(nodes, nodeIndex + 1, rightChild);
+			SetMissLinks(nodes, rightChild, missIndex);
+		}
+	}
+
+	// context.triangleBounds has to be filled in, one box per primitive
+	void BuildPrimitives(BuildContext& context)
+	{
+		unsigned int primitiveCount = (unsigned int)context.triangleBounds.size();
+		context.centroids.resize(primitiveCount);
+		context.triangles.resize(primitiveCount);
+		for (unsigned int p = 0; p < primitiveCount; p++)
+		{
+			context.centroids[p] = 0.5f * (context.triangleBounds[p].min + context.triangleBounds[p].max);
+			context.triangles[p] = p;
+		}
+
+		// at most 2n - 1 nodes, reserving keeps the references in BuildNode cheap to take
+		context.nodes.reserve(2 * primitiveCount - 1);
+		BuildNode(context, 0, primitiveCount, 0);
+		SetMissLinks(context.nodes, 0, (unsigned int)context.nodes.size());
+		context.stats.nodeCount = (unsigned int)context.nodes.size();
+	}
+
+	BuildStats Build(const std::vector<glm::vec3>& positions, const std::vector<unsigned int>& indices,
+					 std::vector<Node>& nodes, std::vector<unsigned int>& bvhIndices)
+	{
+		auto startTime = std::chrono::high_resolution_clock::now();
+
+		BuildStats stats{};
+		unsigned int triangleCount = (unsigned int)(indices.size() / 3);
+		stats.triangleCount = triangleCount;
+		nodes.clear();
+		bvhIndices.clear();
+		if (triangleCount == 0)
+			return stats;
+
+		BuildContext context{ {}, {}, {}, nodes, stats };
+		context.triangleBounds.resize(triangleCount);
+		for (unsigned int t = 0; t < triangleCount; t++)
+		{
+			for (int k = 0; k < 3; k++)
+				context.triangleBounds[t].Grow(positions[indices[3 * t + k]]);
+		}
+		BuildPrimitives(context);
+
+		bvhIndices.reserve(indices.size());
+		for (unsigned int triangle : context.triangles)
+		{
+			for (int k = 0; k < 3; k++)
+				bvhIndices.push_back(indices[3 * triangle + k]);
+		}
+
+		std::chrono::duration<float, std::milli> buildTime = std::chrono::high_resolution_clock::now() - startTime;
+		stats.buildMilliseconds = buildTime.count();
+		return stats;
+	}
+
+	BuildStats Build(const std::vector<glm::vec3>& primitiveMin, const std::vector<glm::vec3>& primitiveMax,
+					 std::vector<Node>& nodes, std::vector<unsigned int>& primitiveOrder)
+	{
+		auto startTime = std::chrono::high_resolution_clock::now();
+
+		BuildStats stats{};
+		unsigned int primitiveCount = (unsigned int)primitiveMin.size();
+		stats.triangleCount = primitiveCount;
+		nodes.clear();
+		primitiveOrder.clear();
+		if (primitiveCount == 0)
+			return stats;
+
+		BuildContext context{ {}, {}, {}, nodes, stats };
+		context.triangleBounds.resize(primitiveCount);
+		for (unsigned int p = 0; p < primitiveCount; p++)
+		{
+			context.triangleBounds[p].Grow(primitiveMin[p]);
+			context.triangleBounds[p].Grow(primitiveMax[p]);
+		}
+		BuildPrimitives(context);
+		primitiveOrder = context.triangles;
+
+		std::chrono::duration<float, std::milli> buildTime = std::chrono::high_resolution_clock::now() - startTime;
+		stats.buildMilliseconds = buildTime.count();
+		return stats;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// binned SAH bounding volume hierarchy over an indexed triangle list or a set of boxes, built on the CPU for ray casting on the GPU
+namespace Bvh
+{
+	const int BIN_COUNT = 16;
+	const unsigned int MAX_LEAF_SIZE = 8; // larger leaves are split even if the SAH says otherwise
+	const float TRAVERSAL_COST = 1.0f; // relative to one triangle test
+
+	// std430 layout shared with photonTrace.glsl
+	// nodes are stored depth first, so an inner node's left child comes right after it
+	struct Node
+	{
+		float minX, minY, minZ;
+		float maxX, maxY, maxZ;
+		unsigned int missIndex; // next node after skipping or finishing this subtree, the node count ends traversal
+		unsigned int triangleOffset; // first triangle (or primitive) for leaves, right child for inner nodes
+		unsigned int triangleCount; // 0 for inner nodes
+	};
+
+	struct BuildStats
+	{
+		float buildMilliseconds = 0.0f;
+		unsigned int triangleCount = 0;
+		unsigned int nodeCount = 0, leafCount = 0, maxDepth = 0;
+		float sahCost = 0.0f; // expected cost of a ray hitting the root box, in triangle tests
+	};
+
+	// bvhIndices gets the triangles of indices reordered so every leaf is one contiguous range
+	BuildStats Build(const std::vector<glm::vec3>& positions, const std::vector<unsigned int>& indices,
+					 std::vector<Node>& nodes, std::vector<unsigned int>& bvhIndices);
+	// same over arbitrary primitives, primitiveOrder gets the primitive of every leaf slot
+	BuildStats Build(const std::vector<glm::vec3>& primitiveMin, const std::vector<glm::vec3>& primitiveMax,
+					 std::vector<Node>& nodes, std::vector<unsigned int>& primitiveOrder);
+}
\ No newline at end of file
@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <vector>
+
+#include "CausticDenoiser.h"
+
+#include "Renderer.h"
+
+CausticDenoiser::CausticDenoiser()
+{
+	glGenFramebuffers(1, &guideFramebuffer);
+	glGenRenderbuffers(1, &guideDepth);
+}
+
+void CausticDenoiser::Recreate(int newResolution)
+{
+	if (newResolution == resolution)
+		return;
+	resolution = newResolution;
+	historyValid = false;
+
+	glDeleteTextures(1, &guideTex);
+	glDeleteTextures(1, &historyTex);
+	glDeleteTextures(2, filterTex);
+	std::vector<float> zeros(resolution * resolution, 0.0f);
+	guideTex = Renderer::CreateTexture2D(resolution, resolution, GL_RGBA32F, GL_RGBA, GL_FLOAT, nullptr);
+	historyTex = Renderer::CreateTexture2D(resolution, resolution, GL_R32F, GL_RED, GL_FLOAT, zeros.data(), GL_LINEAR);
+	for (int i = 0; i < 2; i++)
+		filterTex[i] = Renderer::CreateTexture2D(resolution, resolution, GL_R32F, GL_RED, GL_FLOAT, zeros.data(), GL_LINEAR);
+
+	glBindRenderbuffer(GL_RENDERBUFFER, guideDepth);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, resolution, resolution);
+	glBindFramebuffer(GL_FRAMEBUFFER, guideFramebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, guideTex, 0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, guideDepth);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void CausticDenoiser::BeginGuide(CausticMap& causticMap)
+{
+	downsample = std::clamp(downsample, 1, MAX_DOWNSAMPLE);
+	Recreate(std::max(causticMap.GetResolution() / downsample, 1));
+
+	// the caller's viewport has to survive, it's only set once for the window
+	glGetIntegerv(GL_VIEWPORT, prevViewport);
+	glBindFramebuffer(GL_FRAMEBUFFER, guideFramebuffer);
+	glViewport(0, 0, resolution, resolution);
+	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	// the highest receiver wins
+	glm::mat4 P = causticMap.GetTopDownProjection(GUIDE_HEIGHT_RANGE);
+	glm::mat4 V{ 1.0f };
+	Renderer::UseShader(ShaderMode::CausticGuide);
+	Renderer::SetMat4("P", P);
+	Renderer::SetMat4("V", V);
+}
+
+void CausticDenoiser::EndGuide()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(prevViewport[0], prevViewport[1], prevViewport[2], prevViewport[3]);
+}
+
+void CausticDenoiser::Denoise(CausticMap& causticMap)
+{
+	iterationCount = std::clamp(iterationCount, 1, MAX_ITERATIONS);
+	int workGroupCount = (resolution + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE;
+
+	Renderer::UseShader(ShaderMode::ComputeCausticTemporal);
+	Renderer::SetTexture2D(GL_TEXTURE0, "irradianceTex", causticMap.GetIrradianceTexture());
+	Renderer::SetTexture2D(GL_TEXTURE1, "historyTex", historyTex);
+	Renderer::SetImage(0, "outImage", filterTex[0], GL_WRITE_ONLY, GL_R32F);
+	Renderer::SetInt("downsample", causticMap.GetResolution() / resolution);
+	glm::vec2 regionMin = causticMap.GetRegionMin();
+	Renderer::SetVec2("causticRegionMin", regionMin.x, regionMin.y);
+	Renderer::SetFloat("causticRegionSize", causticMap.GetRegionSize());
+	Renderer::SetVec2("prevCausticRegionMin", prevRegionMin.x, prevRegionMin.y);
+	Renderer::SetFloat("prevCausticRegionSize", prevRegionSize);
+	Renderer::SetInt("historyValid", historyValid);
+	Renderer::SetFloat("blend", blend);
+	glDispatchCompute(workGroupCount, workGroupCount, 1);
+	glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+	Renderer::UseShader(ShaderMode::ComputeCausticAtrous);
+	Renderer::SetImage(3, "guideImage", guideTex, GL_READ_ONLY, GL_RGBA32F);
+	Renderer::SetImage(2, "historyImage", historyTex, GL_WRITE_ONLY, GL_R32F);
+	Renderer::SetFloat("normalPhi", normalPhi);
+	Renderer::SetFloat("heightPhi", heightPhi);
+	for (int i = 0; i < iterationCount; i++)
+	{
+		Renderer::SetImage(0, "inImage", filterTex[i % 2], GL_READ_ONLY, GL_R32F);
+		Renderer::SetImage(1, "outImage", filterTex[(i + 1) % 2], GL_WRITE_ONLY, GL_R32F);
+		Renderer::SetInt("stepSize", 1 << i);
+		Renderer::SetInt("writeHistory", i == 0);
+		glDispatchCompute(workGroupCount, workGroupCount, 1);
+		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+	}
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+	historyValid = true;
+	prevRegionMin = regionMin;
+	prevRegionSize = causticMap.GetRegionSize();
+}
+
+void CausticDenoiser::SetIrradianceTexture(GLenum textureUnit, const char* name, CausticMap& causticMap)
+{
+	Renderer::SetTexture2D(textureUnit, name, filterTex[iterationCount % 2]);
+	glm::vec2 regionMin = causticMap.GetRegionMin();
+	Renderer::SetVec2("causticRegionMin", regionMin.x, regionMin.y);
+	Renderer::SetFloat("causticRegionSize", causticMap.GetRegionSize());
+}
\ No newline at end of file
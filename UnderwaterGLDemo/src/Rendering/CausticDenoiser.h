@@ -0,0 +1,49 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "CausticMap.h"
+
+// spatiotemporal filter for the caustic map at a fraction of its resolution
+// a top-down guide of receiver normals and heights keeps the a-trous iterations from blurring across receivers,
+// the history is reprojected by the region's movement and clamped to the current neighbourhood
+class CausticDenoiser
+{
+public:
+	static const int WORK_GROUP_SIZE = 16;
+	static const int MAX_DOWNSAMPLE = 4;
+	static const int MAX_ITERATIONS = 5;
+	static constexpr float GUIDE_HEIGHT_RANGE = 100.0f; // receivers are expected within this of y = 0
+
+private:
+	GLuint guideFramebuffer, guideDepth;
+	GLuint guideTex = 0, historyTex = 0;
+	GLuint filterTex[2]{};
+	int resolution = 0;
+	bool historyValid = false;
+	glm::vec2 prevRegionMin{};
+	float prevRegionSize = 1.0f;
+	GLint prevViewport[4];
+
+	void Recreate(int newResolution);
+
+public:
+	int downsample = 2;
+	int iterationCount = 4;
+	float blend = 0.1f;
+	float normalPhi = 32.0f;
+	float heightPhi = 0.1f;
+
+	CausticDenoiser();
+	// the receivers rendered between these two with the guide shader bound make up the guide
+	void BeginGuide(CausticMap& causticMap);
+	void EndGuide();
+	// filters the caustic map's irradiance after its resolve
+	void Denoise(CausticMap& causticMap);
+	inline void ResetHistory() { historyValid = false; }
+	// binds the filtered irradiance and the region uniforms, like CausticMap::SetIrradianceTexture
+	void SetIrradianceTexture(GLenum textureUnit, const char* name, CausticMap& causticMap);
+
+	inline int GetResolution() { return resolution; }
+};
\ No newline at end of file
@@ -0,0 +1,107 @@
+#include <algorithm>
+#include <vector>
+
+#include "CausticMap.h"
+
+#include "Renderer.h"
+
+CausticMap::CausticMap(int resolution, glm::vec2 regionCenter, float regionSize)
+{
+	glGenFramebuffers(1, &framebuffer);
+	SetRegion(regionCenter, regionSize);
+	Recreate(resolution);
+}
+
+void CausticMap::Recreate(int newResolution)
+{
+	newResolution = std::clamp(newResolution, MIN_RESOLUTION, MAX_RESOLUTION);
+	if (newResolution == resolution)
+		return;
+	resolution = newResolution;
+	accumulatedFrames = 0;
+	accumulatedPhotons = 0.0;
+
+	glDeleteTextures(1, &accumulationTex);
+	glDeleteTextures(1, &irradianceTex);
+	// the resolve keeps the accumulation cleared, both only have to start out empty
+	std::vector<unsigned int> zeros(resolution * resolution, 0);
+	accumulationTex = Renderer::CreateTexture2D(resolution, resolution, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, zeros.data());
+	irradianceTex = Renderer::CreateTexture2D(resolution, resolution, GL_R32F, GL_RED, GL_FLOAT, zeros.data(), GL_LINEAR);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, irradianceTex, 0);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void CausticMap::SetRegion(glm::vec2 center, float size)
+{
+	glm::vec2 newRegionMin = center - size / 2.0f;
+	if (newRegionMin != regionMin || size != regionSize)
+	{
+		accumulatedFrames = 0;
+		accumulatedPhotons = 0.0;
+	}
+	regionMin = newRegionMin;
+	regionSize = size;
+}
+
+void CausticMap::BindAccumulation(GLuint imageUnit, const char* name)
+{
+	Renderer::SetImage(imageUnit, name, accumulationTex, GL_READ_WRITE, GL_R32UI);
+	Renderer::SetVec2("causticRegionMin", regionMin.x, regionMin.y);
+	Renderer::SetFloat("causticRegionSize", regionSize);
+	Renderer::SetFloat("causticFixedPointScale", FIXED_POINT_SCALE);
+}
+
+void CausticMap::Resolve(float photonFlux, unsigned int photonCount, float minBlend)
+{
+	float texelSize = regionSize / resolution;
+	accumulatedFrames++;
+	accumulatedPhotons += photonCount;
+	// passes of different sizes, like the chunks of a bake, count by how many photons they traced
+	float blend = std::max((float)(photonCount / accumulatedPhotons), minBlend);
+
+	glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+	Renderer::UseShader(ShaderMode::ComputeCausticResolve);
+	Renderer::SetImage(0, "accumulationImage", accumulationTex, GL_READ_WRITE, GL_R32UI);
+	Renderer::SetImage(1, "irradianceImage", irradianceTex, GL_READ_WRITE, GL_R32F);
+	Renderer::SetFloat("splatToIrradiance", photonFlux / (FIXED_POINT_SCALE * texelSize * texelSize));
+	Renderer::SetFloat("blend", blend);
+	int workGroupCount = (resolution + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE;
+	glDispatchCompute(workGroupCount, workGroupCount, 1);
+	glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+}
+
+void CausticMap::BindFramebuffer()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glViewport(0, 0, resolution, resolution);
+	Renderer::SetVec2("causticRegionMin", regionMin.x, regionMin.y);
+	Renderer::SetFloat("causticRegionSize", regionSize);
+	accumulatedFrames = 0;
+	accumulatedPhotons = 0.0;
+}
+
+void CausticMap::ResetAccumulation()
+{
+	accumulatedFrames = 0;
+	accumulatedPhotons = 0.0;
+}
+
+void CausticMap::SetIrradianceTexture(GLenum textureUnit, const char* name)
+{
+	Renderer::SetTexture2D(textureUnit, name, irradianceTex);
+	Renderer::SetVec2("causticRegionMin", regionMin.x, regionMin.y);
+	Renderer::SetFloat("causticRegionSize", regionSize);
+}
+
+glm::mat4 CausticMap::GetTopDownProjection(float heightRange)
+{
+	// orthographic from above, x and z map to the texture coordinates and the highest receiver gets the smallest depth
+	glm::mat4 P{ 0.0f };
+	P[0][0] = 2.0f / regionSize;
+	P[2][1] = 2.0f / regionSize;
+	P[1][2] = -1.0f / heightRange;
+	P[3] = glm::vec4{ -2.0f * regionMin.x / regionSize - 1.0f, -2.0f * regionMin.y / regionSize - 1.0f, 0.0f, 1.0f };
+	return P;
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// receiver-space caustics, photons that went through the water are splatted top-down over a square XZ region
+// splats are fixed point so the photon kernel can accumulate them with imageAtomicAdd
+class CausticMap
+{
+public:
+	static const int MIN_RESOLUTION = 64;
+	static const int MAX_RESOLUTION = 2048;
+	static const int WORK_GROUP_SIZE = 16;
+	// one photon of full flux adds this much, leaves room for ~4M photons in a single texel
+	static constexpr float FIXED_POINT_SCALE = 1024.0f;
+
+private:
+	GLuint accumulationTex = 0, irradianceTex = 0;
+	GLuint framebuffer;
+	int resolution = 0;
+	glm::vec2 regionMin;
+	float regionSize;
+	int accumulatedFrames = 0;
+	double accumulatedPhotons = 0.0; // a uint runs out after a few thousand frames of a large budget
+
+public:
+	CausticMap(int resolution, glm::vec2 regionCenter, float regionSize);
+	void Recreate(int newResolution);
+	void SetRegion(glm::vec2 center, float size);
+
+	// binds the accumulation image and the region uniforms for the photon kernel
+	void BindAccumulation(GLuint imageUnit, const char* name);
+	// turns the splats of photonCount photons of photonFlux each into irradiance, clears the accumulation for the next pass
+	// passes are averaged weighted by their photon count until a pass's weight drops to minBlend,
+	// after that the history fades exponentially
+	void Resolve(float photonFlux, unsigned int photonCount, float minBlend = 1.0f);
+	// the next resolve replaces the history, for when the light or the receivers moved
+	void ResetAccumulation();
+	// binds the irradiance texture as the render target with a matching viewport and the region uniforms
+	// rasterised caustics replace the irradiance, so the history is dropped
+	void BindFramebuffer();
+	// binds the irradiance texture and the region uniforms for the receiver shaders
+	void SetIrradianceTexture(GLenum textureUnit, const char* name);
+	// projection for top-down passes over the region, with an identity view, receivers within heightRange of y = 0
+	glm::mat4 GetTopDownProjection(float heightRange);
+
+	inline int GetResolution() { return resolution; }
+	inline glm::vec2 GetRegionMin() { return regionMin; }
+	inline float GetRegionSize() { return regionSize; }
+	inline GLuint GetIrradianceTexture() { return irradianceTex; }
+	inline int GetAccumulatedFrames() { return accumulatedFrames; }
+};
\ No newline at end of file
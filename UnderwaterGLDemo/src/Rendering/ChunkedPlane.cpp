@@ -0,0 +1,131 @@
+#include <algorithm>
+
+#include "ChunkedPlane.h"
+
+#include "Renderer.h"
+
+void CalculateXZChunk(unsigned int vertexCount, unsigned int chunkCount, float size,
+					  std::vector<PositionTexSurfaceVertex>& vert, std::vector<unsigned int>& ind,
+					  std::vector<glm::vec4>& chunkOffsets, std::vector<ChunkInfo>& chunkInfo);
+
+ChunkedPlane::ChunkedPlane(Material mat, std::vector<PositionTexSurfaceVertex>& vert, std::vector<unsigned int>& ind,
+						   std::vector<glm::vec4>& chunkOffsets, std::vector<ChunkInfo>& chunkInfo, unsigned int chunkCount) :
+	Model(mat, vert, ind),
+	chunkCount(chunkCount)
+{
+	mesh.BindVertexArray();
+	glGenBuffers(1, &chunkOffsetBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, chunkOffsetBuffer);
+	glBufferData(GL_ARRAY_BUFFER, chunkOffsets.size() * sizeof(glm::vec4), &chunkOffsets[0], GL_STATIC_DRAW);
+	glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (void*)0);
+	glEnableVertexAttribArray(2);
+	glVertexAttribDivisor(2, instanceDivisor);
+
+	glGenBuffers(1, &ssboChunkInfo);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, ssboChunkInfo);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, chunkInfo.size() * sizeof(ChunkInfo), &chunkInfo[0], GL_DYNAMIC_COPY);
+}
+
+void ChunkedPlane::Recreate(unsigned int vertexCount, unsigned int newChunkCount, float size)
+{
+	std::vector<PositionTexSurfaceVertex> vert{};
+	std::vector<unsigned int> ind{};
+	std::vector<glm::vec4> chunkOffsets{};
+	std::vector<ChunkInfo> chunkInfo{};
+	CalculateXZChunk(vertexCount, newChunkCount, size, vert, ind, chunkOffsets, chunkInfo);
+	chunkCount = newChunkCount;
+
+	mesh.ReplaceData(vert, ind);
+	glBindBuffer(GL_ARRAY_BUFFER, chunkOffsetBuffer);
+	glBufferData(GL_ARRAY_BUFFER, chunkOffsets.size() * sizeof(glm::vec4), &chunkOffsets[0], GL_STATIC_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, ssboChunkInfo);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, chunkInfo.size() * sizeof(ChunkInfo), &chunkInfo[0], GL_DYNAMIC_COPY);
+}
+
+void ChunkedPlane::RenderInstanced(int patchInstanceCount, bool ignoreModelMatrix, const char* modelMatrixName)
+{
+	// chunk offsets advance once per patchInstanceCount instances, the shader gets the patch from gl_InstanceID
+	if (instanceDivisor != patchInstanceCount)
+	{
+		instanceDivisor = patchInstanceCount;
+		mesh.BindVertexArray();
+		glVertexAttribDivisor(2, instanceDivisor);
+	}
+	Model::RenderInstanced(chunkCount * chunkCount * patchInstanceCount, ignoreModelMatrix, modelMatrixName);
+}
+
+void ChunkedPlane::BindChunkInfoSSBO(int bindingChunkInfo)
+{
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, bindingChunkInfo, ssboChunkInfo);
+}
+
+unsigned int ChunkedPlane::GetChunkCount()
+{
+	return chunkCount * chunkCount;
+}
+
+ChunkedPlane MakeChunkedXZPlane(Material mat, unsigned int vertexCount, unsigned int chunkCount, float size)
+{
+	std::vector<PositionTexSurfaceVertex> vert{};
+	std::vector<unsigned int> ind{};
+	std::vector<glm::vec4> chunkOffsets{};
+	std::vector<ChunkInfo> chunkInfo{};
+	CalculateXZChunk(vertexCount, chunkCount, size, vert, ind, chunkOffsets, chunkInfo);
+
+	return ChunkedPlane{ mat, vert, ind, chunkOffsets, chunkInfo, chunkCount };
+}
+
+void CalculateXZChunk(unsigned int vertexCount, unsigned int chunkCount, float size,
+					  std::vector<PositionTexSurfaceVertex>& vert, std::vector<unsigned int>& ind,
+					  std::vector<glm::vec4>& chunkOffsets, std::vector<ChunkInfo>& chunkInfo)
+{
+	// every chunk gets the same number of cells, so the grid is rounded to a multiple of chunkCount
+	unsigned int cellsPerChunk = std::max(1u, (vertexCount - 1) / chunkCount);
+	unsigned int verticesPerChunk = cellsPerChunk + 1;
+	unsigned int divs = cellsPerChunk * chunkCount;
+	float step = size / divs;
+	float start = -size / 2.0f;
+
+	vert.reserve(verticesPerChunk * verticesPerChunk);
+	ind.reserve(cellsPerChunk * cellsPerChunk * 6);
+	for (unsigned int iix = 0; iix < verticesPerChunk; iix++)
+	{
+		for (unsigned int iiz = 0; iiz < verticesPerChunk; iiz++)
+		{
+			vert.push_back(PositionTexSurfaceVertex{ glm::vec2{ iix * step, iiz * step },
+													 glm::vec2{ (float)iix / divs, (float)iiz / divs } });
+			if (iix < cellsPerChunk && iiz < cellsPerChunk)
+			{
+				unsigned int i = iiz + iix * verticesPerChunk;
+				unsigned int j = i + verticesPerChunk + 1;
+
+				ind.push_back(i);
+				ind.push_back(j);
+				ind.push_back(i + verticesPerChunk);
+
+				ind.push_back(i);
+				ind.push_back(i + 1);
+				ind.push_back(j);
+			}
+		}
+	}
+
+	unsigned int totalVerticesPerChunk = (unsigned int)vert.size();
+	unsigned int indexCount = (unsigned int)ind.size();
+	chunkOffsets.reserve(chunkCount * chunkCount);
+	chunkInfo.reserve(chunkCount * chunkCount);
+	for (unsigned int cx = 0; cx < chunkCount; cx++)
+	{
+		for (unsigned int cz = 0; cz < chunkCount; cz++)
+		{
+			float minX = start + cx * cellsPerChunk * step, minZ = start + cz * cellsPerChunk * step;
+			chunkOffsets.push_back(glm::vec4{ minX, minZ, (float)(cx * cellsPerChunk) / divs, (float)(cz * cellsPerChunk) / divs });
+			chunkInfo.push_back({ 0, totalVerticesPerChunk,
+								  0, indexCount,
+								  minX, minX + cellsPerChunk * step,
+								  0.0f, 0.0f,
+								  minZ, minZ + cellsPerChunk * step,
+								  0.0f, 0.0f });
+		}
+	}
+}
\ No newline at end of file
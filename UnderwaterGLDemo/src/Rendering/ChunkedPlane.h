@@ -0,0 +1,30 @@
+#pragma once
+
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "Model.h"
+#include "Plane.h"
+#include "Vertices.h"
+
+// stores the vertices and indices of a single chunk, every chunk of every patch is an instance of it
+class ChunkedPlane : public Model<PositionTexSurfaceVertex>
+{
+private:
+	GLuint chunkOffsetBuffer;
+	GLuint ssboChunkInfo;
+	unsigned int chunkCount;
+	int instanceDivisor = 1;
+public:
+	ChunkedPlane(Material mat, std::vector<PositionTexSurfaceVertex>& vert, std::vector<unsigned int>& ind,
+				 std::vector<glm::vec4>& chunkOffsets, std::vector<ChunkInfo>& chunkInfo, unsigned int chunkCount);
+	void Recreate(unsigned int vertexCount, unsigned int chunkCount, float size = 1.0f);
+	void RenderInstanced(int patchInstanceCount, bool ignoreModelMatrix = false, const char* modelMatrixName = "M");
+	void BindChunkInfoSSBO(int bindingChunkInfo);
+
+	unsigned int GetChunkCount();
+};
+
+ChunkedPlane MakeChunkedXZPlane(Material mat, unsigned int vertexCount, unsigned int chunkCount, float size = 1.0f);
\ No newline at end of file
@@ -0,0 +1,70 @@
+#include <algorithm>
+#include <cmath>
+
+#include "ClipmapPlane.h"
+
+#include "Renderer.h"
+#include <glm/gtc/matrix_transform.hpp>
+
+ClipmapPlane::ClipmapPlane(Material mat, int levelCount, int cellCount, unsigned int gridVertexCount)
+	: material(mat), position{}, scale{ 1.0f }
+{
+	glGenVertexArrays(1, &vao);
+	Recreate(levelCount, cellCount, gridVertexCount);
+}
+
+void ClipmapPlane::Recreate(int newLevelCount, int newCellCount, unsigned int gridVertexCount)
+{
+	levelCount = std::clamp(newLevelCount, MIN_LEVEL_COUNT, MAX_LEVEL_COUNT);
+	// ring bounds have to land on the coarser level's grid, which needs a multiple of 4
+	cellCount = std::clamp(newCellCount - newCellCount % 4, MIN_CELL_COUNT, MAX_CELL_COUNT);
+	// finest level matches the full grid's spacing, rounded to a power of two so the levels line up exactly in floats
+	baseCellSize = exp2f(-roundf(log2f((float)std::max(gridVertexCount - 1, 1u))));
+}
+
+void ClipmapPlane::Render(glm::vec3 cameraPos, bool ignoreModelMatrix, const char* modelMatrixName)
+{
+	material.Set();
+	if (!ignoreModelMatrix)
+		EnableModelMatrix(modelMatrixName);
+
+	glm::vec3 localCameraPos = (cameraPos - position) / scale;
+	Renderer::SetInt("clipmapCellCount", cellCount);
+	Renderer::SetInt("clipmapLevelCount", levelCount);
+	Renderer::SetFloat("clipmapBaseCellSize", baseCellSize);
+	Renderer::SetVec2("clipmapCenter", localCameraPos.x, localCameraPos.z);
+
+	glBindVertexArray(vao);
+	glDrawArraysInstanced(GL_TRIANGLES, 0, 6 * cellCount * cellCount, levelCount);
+}
+
+void ClipmapPlane::EnableModelMatrix(const char* modelMatrixName)
+{
+	glm::mat4 M{ 1.0f };
+	M = glm::translate(M, position);
+	M = glm::scale(M, glm::vec3{ scale });
+
+	Renderer::SetMat4(modelMatrixName, M);
+}
+
+void ClipmapPlane::SetColor(float newCol[3])
+{
+	material.ambientColor = glm::vec3(newCol[0], newCol[1], newCol[2]);
+}
+
+void ClipmapPlane::SetScale(float newScale)
+{
+	scale = newScale;
+}
+
+unsigned int ClipmapPlane::GetTriangleCount()
+{
+	// levels above the first lose the quarter covered by the finer level
+	unsigned int levelTriangles = 2 * cellCount * cellCount;
+	return levelTriangles + (levelCount - 1) * (levelTriangles - levelTriangles / 4);
+}
+
+float ClipmapPlane::GetExtent()
+{
+	return cellCount * baseCellSize * exp2f((float)(levelCount - 1)) * scale;
+}
\ No newline at end of file
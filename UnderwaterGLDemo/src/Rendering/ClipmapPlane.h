@@ -0,0 +1,38 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "Material.h"
+
+// nested square rings around the camera, each level has the same number of cells and twice the spacing of the previous one
+// the grid is built from gl_VertexID, so there are no buffers to regenerate
+class ClipmapPlane
+{
+public:
+	static const int MIN_LEVEL_COUNT = 1;
+	static const int MAX_LEVEL_COUNT = 12;
+	static const int MIN_CELL_COUNT = 8;
+	static const int MAX_CELL_COUNT = 256;
+
+private:
+	GLuint vao;
+	Material material;
+	int levelCount;
+	int cellCount;
+	float baseCellSize;
+
+	glm::vec3 position;
+	float scale;
+public:
+	ClipmapPlane(Material mat, int levelCount, int cellCount, unsigned int gridVertexCount);
+	void Recreate(int newLevelCount, int newCellCount, unsigned int gridVertexCount);
+	void Render(glm::vec3 cameraPos, bool ignoreModelMatrix = false, const char* modelMatrixName = "M");
+	void EnableModelMatrix(const char* modelMatrixName = "M");
+
+	void SetColor(float newCol[3]);
+	void SetScale(float newScale);
+
+	unsigned int GetTriangleCount();
+	float GetExtent();
+};
\ No newline at end of file
@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "DynamicPointMesh.h"
 
 #include "Renderer.h"
@@ -20,7 +22,7 @@ DynamicPointMesh::DynamicPointMesh(unsigned int pointCount, float pointSize, glm
 	glEnableVertexAttribArray(0);
 }
 
-void DynamicPointMesh::Render(bool showOnTop)
+void DynamicPointMesh::Render(bool showOnTop, unsigned int drawCount)
 {
 	if (showOnTop)
 		glDisable(GL_DEPTH_TEST);
@@ -28,7 +30,7 @@ void DynamicPointMesh::Render(bool showOnTop)
 	Renderer::SetVec4("color", color);
 
 	glBindVertexArray(vao);
-	glDrawArrays(GL_POINTS, 0, pointCount);
+	glDrawArrays(GL_POINTS, 0, std::min(drawCount, pointCount));
 
 	if (showOnTop)
 		glEnable(GL_DEPTH_TEST);
@@ -14,6 +14,7 @@ private:
 	glm::vec4 color;
 public:
 	DynamicPointMesh(unsigned int pointCount, float pointSize, glm::vec4 color);
-	void Render(bool showOnTop = false);
+	// drawCount limits the points to the ones written this frame
+	void Render(bool showOnTop = false, unsigned int drawCount = ~0u);
 	void BindVertexSSBO(int bindingVertex);
 };
\ No newline at end of file
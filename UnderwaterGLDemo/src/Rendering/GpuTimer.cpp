@@ -0,0 +1,62 @@
+#include "GpuTimer.h"
+
+const float AVERAGE_WEIGHT = 0.05f;
+
+GpuTimer::GpuTimer()
+{
+	glGenQueries(QUERY_COUNT, queries.data());
+}
+
+void GpuTimer::Collect(int index, bool wait)
+{
+	if (!pending[index])
+		return;
+
+	if (!wait)
+	{
+		GLint available = 0;
+		glGetQueryObjectiv(queries[index], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available)
+			return;
+	}
+
+	GLuint64 elapsed;
+	glGetQueryObjectui64v(queries[index], GL_QUERY_RESULT, &elapsed);
+	pending[index] = false;
+
+	lastMilliseconds = elapsed / 1000000.0f;
+	averageMilliseconds = averageMilliseconds == 0.0f ? lastMilliseconds
+		: averageMilliseconds + AVERAGE_WEIGHT * (lastMilliseconds - averageMilliseconds);
+}
+
+void GpuTimer::Begin(bool waitForSlot)
+{
+	Collect(current, waitForSlot);
+	// the query in this slot is still in flight, skip this measurement unless the caller waited for it
+	active = !pending[current];
+	if (active)
+		glBeginQuery(GL_TIME_ELAPSED, queries[current]);
+}
+
+void GpuTimer::End()
+{
+	if (!active)
+		return;
+	glEndQuery(GL_TIME_ELAPSED);
+	pending[current] = true;
+	active = false;
+	current = (current + 1) % QUERY_COUNT;
+}
+
+void GpuTimer::Update()
+{
+	for (int i = 0; i < QUERY_COUNT; i++)
+		Collect((current + i) % QUERY_COUNT, false);
+}
+
+float GpuTimer::Wait()
+{
+	for (int i = 0; i < QUERY_COUNT; i++)
+		Collect((current + i) % QUERY_COUNT, true);
+	return lastMilliseconds;
+}
\ No newline at end of file
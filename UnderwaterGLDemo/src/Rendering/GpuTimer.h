@@ -0,0 +1,38 @@
+#pragma once
+
+#include <array>
+
+#include <glad/glad.h>
+
+// GL_TIME_ELAPSED queries in a small ring, results are picked up a few frames later without waiting
+class GpuTimer
+{
+public:
+	static const int QUERY_COUNT = 4;
+
+private:
+	std::array<GLuint, QUERY_COUNT> queries;
+	std::array<bool, QUERY_COUNT> pending{};
+	int current = 0;
+	bool active = false;
+
+	float lastMilliseconds = 0.0f;
+	float averageMilliseconds = 0.0f;
+
+	void Collect(int index, bool wait);
+
+public:
+	GpuTimer();
+
+	// Begin/End pairs can't be nested with other timers, GL allows one GL_TIME_ELAPSED query at a time
+	// waitForSlot blocks on a query still in flight in the next slot instead of skipping the measurement,
+	// a Begin before Wait needs it, otherwise Wait returns an older result
+	void Begin(bool waitForSlot = false);
+	void End();
+	void Update();
+	// blocks until the last finished Begin/End pair is available, meant for benchmarks
+	float Wait();
+
+	inline float GetMilliseconds() { return lastMilliseconds; }
+	inline float GetAverageMilliseconds() { return averageMilliseconds; }
+};
\ No newline at end of file
@@ -0,0 +1,13 @@
+#include <cmath>
+
+#include "Light.h"
+#include "Renderer.h"
+
+void Light::Set()
+{
+	glm::vec3 axis = glm::normalize(direction);
+	Renderer::SetVec3("lightPos", position);
+	Renderer::SetVec3("lightCol", color);
+	Renderer::SetVec3("lightDir", axis);
+	Renderer::SetFloat("lightCosCone", cosf(glm::radians(coneAngle)));
+}
\ No newline at end of file
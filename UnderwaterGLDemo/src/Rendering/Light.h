@@ -0,0 +1,16 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+// point light with an optional cone, shared by the direct shading and the photon emission
+struct Light
+{
+	glm::vec3 position  = { 0.0f, 10.0f, 0.0f };
+	glm::vec3 color     = { 1.0f, 1.0f, 1.0f };
+	glm::vec3 direction = { 0.0f, -1.0f, 0.0f };	// cone axis
+	float coneAngle = 180.0f;						// degrees from the axis, 180 lights every direction
+	float power = 1000.0f;							// flux carried by the photons, spread over the cone
+
+	// lightPos, lightCol, lightDir and lightCosCone
+	void Set();
+};
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include <algorithm>
+
+#include "LinearBvh.h"
+
+#include "Renderer.h"
+
+const unsigned int RADIX_SIZE = 1 << LinearBvh::RADIX_BITS;
+
+LinearBvh::LinearBvh()
+{
+	glGenBuffers(2, keyBuffers);
+	glGenBuffers(2, valueBuffers);
+	glGenBuffers(1, &histogramBuffer);
+	glGenBuffers(1, &nodeBuffer);
+	glGenBuffers(1, &visitBuffer);
+}
+
+void LinearBvh::Build(Plane& plane)
+{
+	triangleCount = plane.GetIndexCount() / 3;
+	unsigned int workGroupCount = (triangleCount + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE;
+	for (int i = 0; i < 2; i++)
+	{
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, keyBuffers[i]);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, triangleCount * sizeof(unsigned int), nullptr, GL_DYNAMIC_COPY);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, valueBuffers[i]);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, triangleCount * sizeof(unsigned int), nullptr, GL_DYNAMIC_COPY);
+	}
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, histogramBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, workGroupCount * RADIX_SIZE * sizeof(unsigned int), nullptr, GL_DYNAMIC_COPY);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, nodeBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, GetNodeCount() * sizeof(LinearBvhNode), nullptr, GL_DYNAMIC_COPY);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, visitBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, std::max(triangleCount - 1, 1u) * sizeof(unsigned int), nullptr, GL_DYNAMIC_COPY);
+
+	buildTimer.Begin();
+
+	Renderer::UseShader(ShaderMode::ComputeLbvhMorton);
+	Renderer::SetUint("triangleCount", triangleCount);
+	Renderer::SetFloat("gridStart", -plane.GetGridSize() / 2.0f);
+	Renderer::SetFloat("gridSize", plane.GetGridSize());
+	plane.BindSSBOs(0, 1, 2);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, keyBuffers[0]);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, valueBuffers[0]);
+	glDispatchCompute(workGroupCount, 1, 1);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+	// least significant digit first, every pass ping-pongs between the two buffer pairs
+	for (unsigned int shift = 0; shift < KEY_BITS; shift += RADIX_BITS)
+	{
+		int source = (shift / RADIX_BITS) % 2, target = 1 - source;
+
+		Renderer::UseShader(ShaderMode::ComputeRadixHistogram);
+		Renderer::SetUint("elementCount", triangleCount);
+		Renderer::SetUint("shift", shift);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, keyBuffers[source]);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, histogramBuffer);
+		glDispatchCompute(workGroupCount, 1, 1);
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+		histogramScan.Scan(histogramBuffer, workGroupCount * RADIX_SIZE);
+
+		Renderer::UseShader(ShaderMode::ComputeRadixScatter);
+		Renderer::SetUint("elementCount", triangleCount);
+		Renderer::SetUint("shift", shift);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, keyBuffers[source]);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, valueBuffers[source]);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, keyBuffers[target]);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, valueBuffers[target]);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, histogramBuffer);
+		glDispatchCompute(workGroupCount, 1, 1);
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+	}
+	int sorted = (KEY_BITS / RADIX_BITS) % 2;
+
+	Renderer::UseShader(ShaderMode::ComputeLbvhHierarchy);
+	Renderer::SetUint("triangleCount", triangleCount);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, keyBuffers[sorted]);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, valueBuffers[sorted]);
+	plane.BindChunkInfoSSBO(2);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, nodeBuffer);
+	glDispatchCompute(workGroupCount, 1, 1);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+	buildTimer.End();
+	buildMilliseconds = buildTimer.Wait();
+	built = true;
+}
+
+void LinearBvh::Refit(Plane& plane)
+{
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, visitBuffer);
+	glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+
+	Renderer::UseShader(ShaderMode::ComputeLbvhRefit);
+	Renderer::SetUint("triangleCount", triangleCount);
+	plane.BindDisplacedVertexSSBO(0);
+	plane.BindIndexSSBO(1);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, nodeBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, visitBuffer);
+	glDispatchCompute((triangleCount + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE, 1, 1);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void LinearBvh::BindNodeSSBO(int bindingNode)
+{
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, bindingNode, nodeBuffer);
+}
\ No newline at end of file
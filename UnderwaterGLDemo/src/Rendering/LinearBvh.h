@@ -0,0 +1,50 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include "GpuTimer.h"
+#include "Plane.h"
+#include "PrefixScan.h"
+
+// std430 layout shared with the lbvh shaders and photonTrace.glsl
+struct LinearBvhNode
+{
+	float minX, minY, minZ;
+	float maxX, maxY, maxZ;
+	unsigned int left, right; // leaves keep their triangle and its chunk's vertexOffset here
+	unsigned int parent;
+};
+
+// GPU linear BVH over the water plane's triangles, for the patch at the origin
+// built once from Morton codes of the grid, then refit to the displaced vertices every frame
+class LinearBvh
+{
+public:
+	static const unsigned int WORK_GROUP_SIZE = 256;
+	static const unsigned int RADIX_BITS = 4;
+	static const unsigned int KEY_BITS = 32;
+
+private:
+	GLuint keyBuffers[2], valueBuffers[2];
+	GLuint histogramBuffer, nodeBuffer, visitBuffer;
+	unsigned int triangleCount = 0;
+	bool built = false;
+	float buildMilliseconds = 0.0f;
+	GpuTimer buildTimer;
+	PrefixScan histogramScan;
+
+public:
+	LinearBvh();
+	// blocks until the GPU is done, so the build time can be reported
+	void Build(Plane& plane);
+	// expects Plane::UpdateDisplacedVertices to have run this frame
+	void Refit(Plane& plane);
+	inline void Invalidate() { built = false; }
+	inline bool IsBuilt() { return built; }
+
+	void BindNodeSSBO(int bindingNode);
+	// nodes below it are inner nodes, the root is node 0
+	inline unsigned int GetLeafOffset() { return triangleCount - 1; }
+	inline unsigned int GetNodeCount() { return 2 * triangleCount - 1; }
+	inline float GetBuildMilliseconds() { return buildMilliseconds; }
+};
\ No newline at end of file
@@ -9,14 +9,18 @@
 #include "Vertices.h"
 #include "Renderer.h"
 
-template <typename VertexType>
+template <typename VertexType, typename IndexType = unsigned int>
 class Mesh
 {
+public:
+	// 16-bit indices for chunk-local data, 32-bit otherwise
+	static constexpr GLenum INDEX_GL_TYPE = sizeof(IndexType) == sizeof(unsigned short) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
 private:
 	GLuint vbo, ebo, vao;
 protected:
 	std::vector<VertexType> vertices;
-	std::vector<unsigned int> indices;
+	std::vector<IndexType> indices;
 
 	glm::vec3 position;
 	glm::vec3 rotation;
@@ -27,22 +31,25 @@ protected:
 	void CreateBuffers();
 	void PrepareRender(bool ignoreModelMatrix, const char* modelMatrixName);
 public:
-	Mesh(std::vector<VertexType>& vert, std::vector<unsigned int>& ind, GLenum primitive = GL_TRIANGLES);
-	void ReplaceData(std::vector<VertexType>& vert, std::vector<unsigned int>& ind);
+	Mesh(std::vector<VertexType>& vert, std::vector<IndexType>& ind, GLenum primitive = GL_TRIANGLES);
+	void ReplaceData(std::vector<VertexType>& vert, std::vector<IndexType>& ind);
 	void Render(bool ignoreModelMatrix = false, const char* modelMatrixName = "M");
 	void RenderInstanced(int instanceCount, bool ignoreModelMatrix = false, const char* modelMatrixName = "M");
 	void BindVertexSSBO(int bindingVertex);
 	void BindIndexSSBO(int bindingIndex);
+	void BindVertexArray();
 	void EnableModelMatrix(const char* modelMatrixName);
+	glm::mat4 GetModelMatrix();
 
 	void SetScale(float newScale);
 	void SetPosition(glm::vec3 newPos);
 
 	unsigned int GetVertexCount();
+	unsigned int GetIndexCount();
 };
 
-template<typename VertexType>
-inline Mesh<VertexType>::Mesh(std::vector<VertexType>& vert, std::vector<unsigned int>& ind, GLenum primitive) :
+template<typename VertexType, typename IndexType>
+inline Mesh<VertexType, IndexType>::Mesh(std::vector<VertexType>& vert, std::vector<IndexType>& ind, GLenum primitive) :
 	vertices{ vert },
 	indices{ ind },
 	position{}, rotation{}, scale{ 1.0f },
@@ -60,13 +67,13 @@ inline Mesh<VertexType>::Mesh(std::vector<VertexType>& vert, std::vector<unsigne
 	glBufferData(GL_ARRAY_BUFFER, vertices.size() * vertexTypeSize, &vertices[0], GL_STATIC_DRAW);
 
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(IndexType), &indices[0], GL_STATIC_DRAW);
 
 	VertexType::SetVertexAttributes();
 }
 
-template<typename VertexType>
-inline void Mesh<VertexType>::CreateBuffers()
+template<typename VertexType, typename IndexType>
+inline void Mesh<VertexType, IndexType>::CreateBuffers()
 {
 	auto vertexTypeSize = sizeof(VertexType);
 	glBindVertexArray(vao);
@@ -75,73 +82,89 @@ inline void Mesh<VertexType>::CreateBuffers()
 	glBufferData(GL_ARRAY_BUFFER, vertices.size() * vertexTypeSize, &vertices[0], GL_STATIC_DRAW);
 
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(IndexType), &indices[0], GL_STATIC_DRAW);
 }
 
-template<typename VertexType>
-inline void Mesh<VertexType>::ReplaceData(std::vector<VertexType>& vert, std::vector<unsigned int>& ind)
+template<typename VertexType, typename IndexType>
+inline void Mesh<VertexType, IndexType>::ReplaceData(std::vector<VertexType>& vert, std::vector<IndexType>& ind)
 {
 	vertices = vert;
 	indices = ind;
 	CreateBuffers();
 }
 
-template<typename VertexType>
-inline void Mesh<VertexType>::PrepareRender(bool ignoreModelMatrix, const char* modelMatrixName)
+template<typename VertexType, typename IndexType>
+inline void Mesh<VertexType, IndexType>::PrepareRender(bool ignoreModelMatrix, const char* modelMatrixName)
 {
 	if (!ignoreModelMatrix)
 		EnableModelMatrix(modelMatrixName);
 	glBindVertexArray(vao);
 }
 
-template<typename VertexType>
-inline void Mesh<VertexType>::Render(bool ignoreModelMatrix, const char* modelMatrixName)
+template<typename VertexType, typename IndexType>
+inline void Mesh<VertexType, IndexType>::Render(bool ignoreModelMatrix, const char* modelMatrixName)
 {
 	PrepareRender(ignoreModelMatrix, modelMatrixName);
-	glDrawElements(primitiveMode, indices.size(), GL_UNSIGNED_INT, 0);
+	glDrawElements(primitiveMode, indices.size(), INDEX_GL_TYPE, 0);
 }
-template<typename VertexType>
-inline void Mesh<VertexType>::RenderInstanced(int instanceCount, bool ignoreModelMatrix, const char* modelMatrixName)
+template<typename VertexType, typename IndexType>
+inline void Mesh<VertexType, IndexType>::RenderInstanced(int instanceCount, bool ignoreModelMatrix, const char* modelMatrixName)
 {
 	PrepareRender(ignoreModelMatrix, modelMatrixName);
-	glDrawElementsInstanced(primitiveMode, indices.size(), GL_UNSIGNED_INT, 0, instanceCount);
+	glDrawElementsInstanced(primitiveMode, indices.size(), INDEX_GL_TYPE, 0, instanceCount);
 }
 
-template<typename VertexType>
-inline void Mesh<VertexType>::BindVertexSSBO(int bindingVertex)
+template<typename VertexType, typename IndexType>
+inline void Mesh<VertexType, IndexType>::BindVertexSSBO(int bindingVertex)
 {
 	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, bindingVertex, vbo);
 }
-template<typename VertexType>
-inline void Mesh<VertexType>::BindIndexSSBO(int bindingIndex)
+template<typename VertexType, typename IndexType>
+inline void Mesh<VertexType, IndexType>::BindIndexSSBO(int bindingIndex)
 {
 	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, bindingIndex, ebo);
 }
 
-template<typename VertexType>
-inline void Mesh<VertexType>::EnableModelMatrix(const char* modelMatrixName)
+template<typename VertexType, typename IndexType>
+inline void Mesh<VertexType, IndexType>::BindVertexArray()
+{
+	glBindVertexArray(vao);
+}
+
+template<typename VertexType, typename IndexType>
+inline void Mesh<VertexType, IndexType>::EnableModelMatrix(const char* modelMatrixName)
+{
+	glm::mat4 M = GetModelMatrix();
+	Renderer::SetMat4(modelMatrixName, M);
+}
+template<typename VertexType, typename IndexType>
+inline glm::mat4 Mesh<VertexType, IndexType>::GetModelMatrix()
 {
 	// TODO: rotation
 	glm::mat4 M{ 1.0f };
 	M = glm::translate(M, position);
 	M = glm::scale(M, glm::vec3{ scale });
-
-	Renderer::SetMat4(modelMatrixName, M);
+	return M;
 }
 
-template<typename VertexType>
-inline void Mesh<VertexType>::SetScale(float newScale)
+template<typename VertexType, typename IndexType>
+inline void Mesh<VertexType, IndexType>::SetScale(float newScale)
 {
 	scale = newScale;
 }
-template<typename VertexType>
-inline void Mesh<VertexType>::SetPosition(glm::vec3 newPos)
+template<typename VertexType, typename IndexType>
+inline void Mesh<VertexType, IndexType>::SetPosition(glm::vec3 newPos)
 {
 	position = newPos;
 }
 
-template<typename VertexType>
-inline unsigned int Mesh<VertexType>::GetVertexCount()
+template<typename VertexType, typename IndexType>
+inline unsigned int Mesh<VertexType, IndexType>::GetVertexCount()
 {
 	return vertices.size();
+}
+template<typename VertexType, typename IndexType>
+inline unsigned int Mesh<VertexType, IndexType>::GetIndexCount()
+{
+	return indices.size();
 }
\ No newline at end of file
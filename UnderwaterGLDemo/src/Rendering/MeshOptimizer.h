@@ -0,0 +1,221 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// index and vertex reordering for the GPU caches, run on mesh data before it is uploaded
+namespace MeshOptimizer
+{
+	const int CACHE_SIZE = 32; // LRU cache modelled while reordering
+	const unsigned int ANALYZE_CACHE_SIZE = 16; // FIFO cache used for the reports
+
+	struct VertexCacheStats
+	{
+		size_t transformedVertexCount = 0;
+		size_t triangleCount = 0;
+		size_t vertexCount = 0;
+
+		// average cache miss ratio, transformed vertices per triangle (3 means no reuse, a regular grid can get close to 0.5)
+		inline float GetACMR() const { return triangleCount == 0 ? 0.0f : (float)transformedVertexCount / triangleCount; }
+		// average transformed vertex ratio, transformed vertices per vertex (1 is ideal)
+		inline float GetATVR() const { return vertexCount == 0 ? 0.0f : (float)transformedVertexCount / vertexCount; }
+
+		inline VertexCacheStats& operator+=(const VertexCacheStats& other)
+		{
+			transformedVertexCount += other.transformedVertexCount;
+			triangleCount += other.triangleCount;
+			vertexCount += other.vertexCount;
+			return *this;
+		}
+	};
+
+	struct CacheReport
+	{
+		VertexCacheStats before, after;
+
+		inline CacheReport& operator+=(const CacheReport& other)
+		{
+			before += other.before;
+			after += other.after;
+			return *this;
+		}
+	};
+
+	// Forsyth, "Linear-Speed Vertex Cache Optimisation"
+	inline float GetVertexScore(int cachePosition, unsigned int remainingTriangles)
+	{
+		if (remainingTriangles == 0)
+			return -1.0f;
+
+		float score = 0.0f;
+		if (cachePosition >= 0)
+		{
+			// the last triangle's vertices get a fixed score, otherwise the order degrades into strips
+			if (cachePosition < 3)
+				score = 0.75f;
+			else
+				score = powf(1.0f - (cachePosition - 3) / (float)(CACHE_SIZE - 3), 1.5f);
+		}
+		// vertices with few triangles left are worth finishing off
+		return score + 2.0f * powf((float)remainingTriangles, -0.5f);
+	}
+
+	template<typename IndexType>
+	inline VertexCacheStats AnalyzeVertexCache(const IndexType* indices, size_t indexCount, size_t vertexCount,
+											   unsigned int cacheSize = ANALYZE_CACHE_SIZE)
+	{
+		// FIFO, a vertex stays cached until cacheSize misses happened after it was loaded
+		std::vector<size_t> loadedAt(vertexCount, 0);
+		size_t misses = 0;
+		for (size_t i = 0; i < indexCount; i++)
+		{
+			size_t& loaded = loadedAt[indices[i]];
+			if (loaded == 0 || misses - loaded >= cacheSize)
+			{
+				misses++;
+				loaded = misses;
+			}
+		}
+		return VertexCacheStats{ misses, indexCount / 3, vertexCount };
+	}
+
+	// reorders triangles in place
+	template<typename IndexType>
+	inline void OptimizeVertexCache(IndexType* indices, size_t indexCount, size_t vertexCount)
+	{
+		size_t triangleCount = indexCount / 3;
+		if (triangleCount == 0)
+			return;
+
+		// remaining triangles of every vertex, kept at the front of its range in one flat list
+		std::vector<unsigned int> remaining(vertexCount, 0);
+		for (size_t i = 0; i < indexCount; i++)
+			remaining[indices[i]]++;
+		std::vector<unsigned int> adjacencyOffset(vertexCount + 1, 0);
+		for (size_t v = 0; v < vertexCount; v++)
+			adjacencyOffset[v + 1] = adjacencyOffset[v] + remaining[v];
+		std::vector<unsigned int> adjacency(indexCount);
+		std::vector<unsigned int> adjacencyFill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+		for (size_t i = 0; i < indexCount; i++)
+			adjacency[adjacencyFill[indices[i]]++] = (unsigned int)(i / 3);
+
+		std::vector<int> cachePosition(vertexCount, -1);
+		std::vector<float> vertexScore(vertexCount);
+		for (size_t v = 0; v < vertexCount; v++)
+			vertexScore[v] = GetVertexScore(-1, remaining[v]);
+
+		std::vector<float> triangleScore(triangleCount);
+		std::vector<bool> emitted(triangleCount, false);
+		for (size_t t = 0; t < triangleCount; t++)
+			triangleScore[t] = vertexScore[indices[3 * t]] + vertexScore[indices[3 * t + 1]] + vertexScore[indices[3 * t + 2]];
+
+		std::vector<IndexType> output;
+		output.reserve(indexCount);
+		std::vector<unsigned int> cache, nextCache;
+		cache.reserve(CACHE_SIZE + 3);
+		nextCache.reserve(CACHE_SIZE + 3);
+
+		size_t bestTriangle = std::max_element(triangleScore.begin(), triangleScore.end()) - triangleScore.begin();
+		size_t fallbackTriangle = 0;
+		while (output.size() < 3 * triangleCount)
+		{
+			if (bestTriangle == triangleCount)
+			{
+				// nothing in the cache has triangles left, take the next one in the original order
+				while (emitted[fallbackTriangle])
+					fallbackTriangle++;
+				bestTriangle = fallbackTriangle;
+			}
+			emitted[bestTriangle] = true;
+
+			nextCache.clear();
+			for (int k = 0; k < 3; k++)
+			{
+				unsigned int v = indices[3 * bestTriangle + k];
+				output.push_back((IndexType)v);
+				unsigned int* begin = &adjacency[adjacencyOffset[v]];
+				unsigned int* end = begin + remaining[v];
+				std::iter_swap(std::find(begin, end, (unsigned int)bestTriangle), end - 1);
+				remaining[v]--;
+				if (std::find(nextCache.begin(), nextCache.end(), v) == nextCache.end())
+					nextCache.push_back(v);
+			}
+			for (unsigned int v : cache)
+			{
+				if (std::find(nextCache.begin(), nextCache.end(), v) == nextCache.end())
+					nextCache.push_back(v);
+			}
+
+			// rescore everything that moved, including the vertices pushed out of the cache
+			for (size_t i = 0; i < nextCache.size(); i++)
+			{
+				unsigned int v = nextCache[i];
+				cachePosition[v] = i < (size_t)CACHE_SIZE ? (int)i : -1;
+				float newScore = GetVertexScore(cachePosition[v], remaining[v]);
+				float scoreChange = newScore - vertexScore[v];
+				vertexScore[v] = newScore;
+				for (unsigned int j = 0; j < remaining[v]; j++)
+					triangleScore[adjacency[adjacencyOffset[v] + j]] += scoreChange;
+			}
+			if (nextCache.size() > (size_t)CACHE_SIZE)
+				nextCache.resize(CACHE_SIZE);
+			std::swap(cache, nextCache);
+
+			bestTriangle = triangleCount;
+			float bestScore = -1.0f;
+			for (unsigned int v : cache)
+			{
+				for (unsigned int j = 0; j < remaining[v]; j++)
+				{
+					unsigned int t = adjacency[adjacencyOffset[v] + j];
+					if (triangleScore[t] > bestScore)
+					{
+						bestScore = triangleScore[t];
+						bestTriangle = t;
+					}
+				}
+			}
+		}
+
+		std::copy(output.begin(), output.end(), indices);
+	}
+
+	// reorders vertices by first use so fetches walk the vertex buffer forward, indices are remapped in place
+	template<typename VertexType, typename IndexType>
+	inline void OptimizeVertexFetch(VertexType* vertices, IndexType* indices, size_t indexCount, size_t vertexCount)
+	{
+		const unsigned int UNUSED = ~0u;
+		std::vector<unsigned int> remap(vertexCount, UNUSED);
+		unsigned int nextVertex = 0;
+		for (size_t i = 0; i < indexCount; i++)
+		{
+			unsigned int& newIndex = remap[indices[i]];
+			if (newIndex == UNUSED)
+				newIndex = nextVertex++;
+			indices[i] = (IndexType)newIndex;
+		}
+		// unreferenced vertices go to the end, so the vertex count doesn't change
+		for (size_t v = 0; v < vertexCount; v++)
+		{
+			if (remap[v] == UNUSED)
+				remap[v] = nextVertex++;
+		}
+
+		std::vector<VertexType> original(vertices, vertices + vertexCount);
+		for (size_t v = 0; v < vertexCount; v++)
+			vertices[remap[v]] = original[v];
+	}
+
+	// cache reordering followed by fetch reordering, returns the FIFO stats of both orders
+	template<typename VertexType, typename IndexType>
+	inline CacheReport Optimize(VertexType* vertices, IndexType* indices, size_t indexCount, size_t vertexCount)
+	{
+		CacheReport report;
+		report.before = AnalyzeVertexCache(indices, indexCount, vertexCount);
+		OptimizeVertexCache(indices, indexCount, vertexCount);
+		OptimizeVertexFetch(vertices, indices, indexCount, vertexCount);
+		report.after = AnalyzeVertexCache(indices, indexCount, vertexCount);
+		return report;
+	}
+}
\ No newline at end of file
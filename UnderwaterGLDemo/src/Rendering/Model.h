@@ -3,21 +3,22 @@
 #include "Material.h"
 #include "Mesh.h"
 
-template <typename VertexType>
+template <typename VertexType, typename IndexType = unsigned int>
 class Model
 {
 protected:
 	Material material;
-	Mesh<VertexType> mesh;
+	Mesh<VertexType, IndexType> mesh;
 
 public:
-	Model(Material mat, std::vector<VertexType>& vert, std::vector<unsigned int>& ind);
+	Model(Material mat, std::vector<VertexType>& vert, std::vector<IndexType>& ind, GLenum primitive = GL_TRIANGLES);
 	void Render(bool ignoreModelMatrix = false, const char* modelMatrixName = "M");
 	void RenderInstanced(int instanceCount, bool ignoreModelMatrix = false, const char* modelMatrixName = "M");
 	void BindVertexSSBO(int bindingVertex);
 	void BindIndexSSBO(int bindingIndex);
 	void BindSSBOs(int bindingVertex, int bindingIndex);
 	void EnableModelMatrix(const char* modelMatrixName = "M");
+	glm::mat4 GetModelMatrix();
 
 	void SetColor(float newCol[3]);
 	void SetColor(glm::vec3& newCol);
@@ -30,91 +31,102 @@ public:
 	void SetScale(float newScale);
 
 	unsigned int GetVertexCount();
+	unsigned int GetIndexCount();
 };
 
 
-template<typename VertexType>
-inline Model<VertexType>::Model(Material mat, std::vector<VertexType>& vert, std::vector<unsigned int>& ind)
-	: material(mat), mesh(vert, ind)
+template<typename VertexType, typename IndexType>
+inline Model<VertexType, IndexType>::Model(Material mat, std::vector<VertexType>& vert, std::vector<IndexType>& ind, GLenum primitive)
+	: material(mat), mesh(vert, ind, primitive)
 {}
 
-template<typename VertexType>
-inline void Model<VertexType>::Render(bool ignoreModelMatrix, const char* modelMatrixName)
+template<typename VertexType, typename IndexType>
+inline void Model<VertexType, IndexType>::Render(bool ignoreModelMatrix, const char* modelMatrixName)
 {
 	material.Set();
 	mesh.Render(ignoreModelMatrix, modelMatrixName);
 }
 
-template<typename VertexType>
-inline void Model<VertexType>::RenderInstanced(int instanceCount, bool ignoreModelMatrix, const char* modelMatrixName)
+template<typename VertexType, typename IndexType>
+inline void Model<VertexType, IndexType>::RenderInstanced(int instanceCount, bool ignoreModelMatrix, const char* modelMatrixName)
 {
 	material.Set();
 	mesh.RenderInstanced(instanceCount, ignoreModelMatrix, modelMatrixName);
 }
 
-template<typename VertexType>
-inline void Model<VertexType>::BindVertexSSBO(int bindingVertex)
+template<typename VertexType, typename IndexType>
+inline void Model<VertexType, IndexType>::BindVertexSSBO(int bindingVertex)
 {
 	mesh.BindVertexSSBO(bindingVertex);
 }
-template<typename VertexType>
-inline void Model<VertexType>::BindIndexSSBO(int bindingIndex)
+template<typename VertexType, typename IndexType>
+inline void Model<VertexType, IndexType>::BindIndexSSBO(int bindingIndex)
 {
 	mesh.BindIndexSSBO(bindingIndex);
 }
-template<typename VertexType>
-inline void Model<VertexType>::BindSSBOs(int bindingVertex, int bindingIndex)
+template<typename VertexType, typename IndexType>
+inline void Model<VertexType, IndexType>::BindSSBOs(int bindingVertex, int bindingIndex)
 {
 	mesh.BindVertexSSBO(bindingVertex);
 	mesh.BindIndexSSBO(bindingIndex);
 }
 
-template<typename VertexType>
-inline void Model<VertexType>::EnableModelMatrix(const char* modelMatrixName)
+template<typename VertexType, typename IndexType>
+inline void Model<VertexType, IndexType>::EnableModelMatrix(const char* modelMatrixName)
 {
 	mesh.EnableModelMatrix(modelMatrixName);
 }
+template<typename VertexType, typename IndexType>
+inline glm::mat4 Model<VertexType, IndexType>::GetModelMatrix()
+{
+	return mesh.GetModelMatrix();
+}
 
-template<typename VertexType>
-inline void Model<VertexType>::SetColor(float newCol[3])
+template<typename VertexType, typename IndexType>
+inline void Model<VertexType, IndexType>::SetColor(float newCol[3])
 {
 	material.ambientColor = glm::vec3(newCol[0], newCol[1], newCol[2]);
 }
-template<typename VertexType>
-inline void Model<VertexType>::SetColor(glm::vec3& newCol)
+template<typename VertexType, typename IndexType>
+inline void Model<VertexType, IndexType>::SetColor(glm::vec3& newCol)
 {
 	material.ambientColor = newCol;
 }
-template<typename VertexType>
-inline void Model<VertexType>::SetColor(float r, float g, float b)
+template<typename VertexType, typename IndexType>
+inline void Model<VertexType, IndexType>::SetColor(float r, float g, float b)
 {
 	material.ambientColor = glm::vec3(r, g, b);
 }
 
-template<typename VertexType>
-inline void Model<VertexType>::SetPosition(float newPos[3])
+template<typename VertexType, typename IndexType>
+inline void Model<VertexType, IndexType>::SetPosition(float newPos[3])
 {
 	mesh.SetPosition(glm::vec3(newPos[0], newPos[1], newPos[2]));
 }
-template<typename VertexType>
-inline void Model<VertexType>::SetPosition(glm::vec3& newPos)
+template<typename VertexType, typename IndexType>
+inline void Model<VertexType, IndexType>::SetPosition(glm::vec3& newPos)
 {
 	mesh.SetPosition(newPos);
 }
-template<typename VertexType>
-inline void Model<VertexType>::SetPosition(float x, float y, float z)
+template<typename VertexType, typename IndexType>
+inline void Model<VertexType, IndexType>::SetPosition(float x, float y, float z)
 {
 	mesh.SetPosition(glm::vec3(x, y, z));
 }
 
-template<typename VertexType>
-inline void Model<VertexType>::SetScale(float newScale)
+template<typename VertexType, typename IndexType>
+inline void Model<VertexType, IndexType>::SetScale(float newScale)
 {
 	mesh.SetScale(newScale);
 }
 
-template<typename VertexType>
-inline unsigned int Model<VertexType>::GetVertexCount()
+template<typename VertexType, typename IndexType>
+inline unsigned int Model<VertexType, IndexType>::GetVertexCount()
 {
 	return mesh.GetVertexCount();
+}
+template<typename VertexType, typename IndexType>
+inline unsigned int Model<VertexType, IndexType>::GetIndexCount()
+{
+	return mesh.GetIndexCount();
 }
\ No newline at end of file
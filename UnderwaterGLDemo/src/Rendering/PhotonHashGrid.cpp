@@ -0,0 +1,80 @@
+#include "PhotonHashGrid.h"
+
+#include "Renderer.h"
+
+// storedPhotonCount and its padding in front of the photons
+const GLsizeiptr PHOTON_MAP_HEADER_SIZE = 4 * sizeof(unsigned int);
+
+PhotonHashGrid::PhotonHashGrid()
+{
+	glGenBuffers(1, &photonBuffer);
+	glGenBuffers(1, &cellBuffer);
+	glGenBuffers(1, &sortedBuffer);
+	glGenBuffers(1, &rankBuffer);
+}
+
+void PhotonHashGrid::Reset(unsigned int photonCapacity)
+{
+	if (photonCapacity > capacity)
+	{
+		capacity = photonCapacity;
+		// about one slot per photon, a power of two so the hash can be masked
+		tableSize = MIN_TABLE_SIZE;
+		while (tableSize < capacity && tableSize < MAX_TABLE_SIZE)
+			tableSize <<= 1;
+
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, photonBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, PHOTON_MAP_HEADER_SIZE + capacity * sizeof(StoredPhoton), nullptr, GL_DYNAMIC_COPY);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, sortedBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, capacity * sizeof(StoredPhoton), nullptr, GL_DYNAMIC_COPY);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, rankBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, capacity * sizeof(unsigned int), nullptr, GL_DYNAMIC_COPY);
+		// the extra entry ends up as the total, so every slot's end is the next slot's start
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, cellBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, (tableSize + 1) * sizeof(unsigned int), nullptr, GL_DYNAMIC_COPY);
+	}
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, photonBuffer);
+	glClearBufferSubData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, 0, PHOTON_MAP_HEADER_SIZE, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+}
+
+void PhotonHashGrid::BindPhotonSSBO(int bindingPhoton)
+{
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, bindingPhoton, photonBuffer);
+}
+
+void PhotonHashGrid::Build(float newCellSize)
+{
+	cellSize = newCellSize;
+	unsigned int workGroupCount = (capacity + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE;
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, cellBuffer);
+	glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 16, photonBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 17, cellBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 18, sortedBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 19, rankBuffer);
+
+	Renderer::UseShader(ShaderMode::ComputePhotonHashCount);
+	Renderer::SetFloat("photonHashCellSize", cellSize);
+	Renderer::SetUint("photonHashTableMask", tableSize - 1);
+	glDispatchCompute(workGroupCount, 1, 1);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+	cellScan.Scan(cellBuffer, tableSize + 1);
+
+	Renderer::UseShader(ShaderMode::ComputePhotonHashScatter);
+	Renderer::SetFloat("photonHashCellSize", cellSize);
+	Renderer::SetUint("photonHashTableMask", tableSize - 1);
+	glDispatchCompute(workGroupCount, 1, 1);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void PhotonHashGrid::BindQuery()
+{
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 16, photonBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 17, cellBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 18, sortedBuffer);
+	Renderer::SetFloat("photonHashCellSize", cellSize);
+	Renderer::SetUint("photonHashTableMask", tableSize - 1);
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "PrefixScan.h"
+
+// std430 layout shared with photonHash.glsl
+struct StoredPhoton
+{
+	glm::vec3 position;
+	float flux;
+	glm::vec3 direction;
+	unsigned int padding;
+};
+
+// caustic photons deposited by the shade stage, hashed into a uniform grid every frame for radius and k nearest queries
+// the build is a counting sort, a histogram that also ranks every photon within its slot, the shared prefix scan and a scatter
+// everything is sized for the capacity, so the CPU never needs the deposited photon count
+class PhotonHashGrid
+{
+public:
+	static const unsigned int WORK_GROUP_SIZE = 256;
+	static const unsigned int MIN_TABLE_SIZE = 1 << 10;
+	static const unsigned int MAX_TABLE_SIZE = 1 << 22;
+
+private:
+	GLuint photonBuffer, cellBuffer, sortedBuffer, rankBuffer;
+	unsigned int capacity = 0;
+	unsigned int tableSize = 0;
+	float cellSize = 1.0f;
+	PrefixScan cellScan;
+
+public:
+	PhotonHashGrid();
+	// grows the buffers and empties the photon map, before the photons are traced
+	void Reset(unsigned int photonCapacity);
+	void BindPhotonSSBO(int bindingPhoton);
+	// queries must stay within half a cell, see photonHash.glsl
+	void Build(float newCellSize);
+	// binds the sorted photons and sets the hash uniforms, for any shader including photonHash.glsl
+	void BindQuery();
+
+	inline unsigned int GetCapacity() { return capacity; }
+	inline unsigned int GetTableSize() { return tableSize; }
+};
\ No newline at end of file
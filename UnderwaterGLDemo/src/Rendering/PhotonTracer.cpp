@@ -0,0 +1,109 @@
+#include <algorithm>
+
+#include "PhotonTracer.h"
+
+#include "Renderer.h"
+
+// indirect dispatch arguments first, photonQueue.glsl's QueueStateBuffer
+struct QueueState
+{
+	unsigned int dispatchX, dispatchY, dispatchZ;
+	unsigned int inRayCount;
+	unsigned int outRayCount;
+};
+
+PhotonTracer::PhotonTracer()
+{
+	glGenBuffers(2, rayBuffers);
+	glGenBuffers(1, &hitBuffer);
+	glGenBuffers(1, &stateBuffer);
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, stateBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(QueueState), nullptr, GL_DYNAMIC_COPY);
+}
+
+void PhotonTracer::Reserve(unsigned int photonCount)
+{
+	if (photonCount <= capacity)
+		return;
+	capacity = photonCount;
+
+	// the second queue never gets more rays than the first one, every ray leaves at most one survivor
+	for (int i = 0; i < 2; i++)
+	{
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, rayBuffers[i]);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, capacity * sizeof(PhotonRay), nullptr, GL_DYNAMIC_COPY);
+	}
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, hitBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, capacity * sizeof(PhotonHit), nullptr, GL_DYNAMIC_COPY);
+}
+
+void PhotonTracer::Trace(unsigned int photonCount, unsigned int sampleOffset, PhotonEmitOrder emitOrder, int maxDepth,
+						 const std::function<void()>& setStageUniforms)
+{
+	Reserve(photonCount);
+
+	unsigned int groupCount = (photonCount + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE;
+	QueueState initialState{ groupCount, 1, 1, photonCount, 0 };
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, stateBuffer);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(QueueState), &initialState);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 14, hitBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 15, stateBuffer);
+
+	Renderer::UseShader(ShaderMode::ComputePhotonGenerate);
+	Renderer::SetUint("photonCount", photonCount);
+	Renderer::SetUint("photonSampleOffset", sampleOffset);
+	// the largest grid with no more cells than photons, so every pass covers the whole light, tiles need a whole tile
+	unsigned int emitGridSize = EMIT_TILE_SIZE;
+	while (4 * emitGridSize * emitGridSize <= photonCount)
+		emitGridSize *= 2;
+	Renderer::SetInt("photonEmitOrder", static_cast<int>(emitOrder));
+	Renderer::SetUint("photonEmitGridSize", emitGridSize);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 12, rayBuffers[0]);
+	glDispatchCompute(groupCount, 1, 1);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+	glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, stateBuffer);
+	int current = 0;
+	for (int depth = 0; depth < maxDepth; depth++)
+	{
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 12, rayBuffers[current]);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 13, rayBuffers[1 - current]);
+
+		Renderer::UseShader(ShaderMode::ComputePhotonIntersect);
+		setStageUniforms();
+		DispatchStage(photonCount);
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+		Renderer::UseShader(ShaderMode::ComputePhotonShade);
+		setStageUniforms();
+		Renderer::SetUint("maxPhotonDepth", maxDepth);
+		DispatchStage(photonCount);
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+		Renderer::UseShader(ShaderMode::ComputePhotonPrepareDispatch);
+		glDispatchCompute(1, 1, 1);
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+
+		current = 1 - current;
+	}
+}
+
+void PhotonTracer::DispatchStage(unsigned int photonCount)
+{
+	if (maxRaysPerDispatch == 0 || maxRaysPerDispatch >= photonCount)
+	{
+		Renderer::SetUint("photonRayOffset", 0);
+		glDispatchComputeIndirect(0);
+		return;
+	}
+
+	unsigned int raysPerDispatch = (maxRaysPerDispatch + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE * WORK_GROUP_SIZE;
+	for (unsigned int offset = 0; offset < photonCount; offset += raysPerDispatch)
+	{
+		Renderer::SetUint("photonRayOffset", offset);
+		glDispatchCompute((std::min(raysPerDispatch, photonCount - offset) + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE, 1, 1);
+		// every sub-dispatch goes to the driver on its own instead of being batched into one long submission
+		glFlush();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <functional>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// std430 layouts shared with photonQueue.glsl
+struct PhotonRay
+{
+	glm::vec3 origin;
+	float flux;
+	glm::vec3 direction;
+	unsigned int photonId;
+	unsigned int depth;
+	unsigned int flags;
+	unsigned int padding[2];
+};
+struct PhotonHit
+{
+	glm::vec3 normal;
+	float t;
+	unsigned int blas;
+	unsigned int padding[3];
+};
+
+// matches photon_emit_* in photonGenerate.comp
+enum class PhotonEmitOrder
+{
+	Sequence,
+	RowMajor,
+	Tiled,
+	Morton
+};
+
+// wavefront photon tracing, every bounce runs an intersect and a shade stage over the rays that survived the previous one
+// shade appends survivors to a second queue through an atomic counter, a one-thread stage then turns that counter
+// into the indirect dispatch size of the next bounce, so the CPU never waits for a ray count
+class PhotonTracer
+{
+public:
+	static const unsigned int WORK_GROUP_SIZE = 64; // photon_work_group_size
+	static const int MAX_DEPTH = 8;
+	static const unsigned int EMIT_TILE_SIZE = 8; // photon_emit_tile_size
+
+private:
+	GLuint rayBuffers[2], hitBuffer, stateBuffer;
+	unsigned int capacity = 0;
+	unsigned int maxRaysPerDispatch = 0;
+
+	void Reserve(unsigned int photonCount);
+	// indirect over the queue, or split into sub-dispatches of maxRaysPerDispatch rays over the photon count
+	void DispatchStage(unsigned int photonCount);
+
+public:
+	PhotonTracer();
+
+	// emits photonCount photons from the current light, sampleOffset picks where they start in the emission sequence
+	// emitOrder only changes which queue slot a direction lands in, the set of directions stays stratified either way
+	// setStageUniforms runs after every stage's shader is bound, for the geometry, water and caustic uniforms
+	void Trace(unsigned int photonCount, unsigned int sampleOffset, PhotonEmitOrder emitOrder, int maxDepth,
+			   const std::function<void()>& setStageUniforms);
+	// bounds the rays in one dispatch so a slow traversal can't trip the driver's watchdog, 0 keeps one dispatch per stage
+	// the queue length is only known on the GPU, so every bounce goes through all of the photon count's sub-dispatches
+	inline void SetMaxRaysPerDispatch(unsigned int maxRays) { maxRaysPerDispatch = maxRays; }
+};
\ No newline at end of file
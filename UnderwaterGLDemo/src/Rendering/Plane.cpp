@@ -1,41 +1,124 @@
+#include <algorithm>
+#include <execution>
+#include <numeric>
+
 #include "Plane.h"
 
 #include "Renderer.h"
 #include <glm/gtc/matrix_transform.hpp>
 
-void CalculateXZPlane(unsigned int vertexCount, unsigned int chunkCount, float size,
-					  std::vector<PositionTexSurfaceVertex>& vert, std::vector<unsigned int>& ind,
-					  std::vector<ChunkInfo>& chunkInfo);
+const unsigned int CULLING_WORK_GROUP_SIZE = 256;
+const unsigned int BOUNDING_BOX_WORK_GROUP_SIZE = 64;
+const unsigned int DISPLACE_WORK_GROUP_SIZE = 256;
+
+unsigned int CalculateXZPlane(unsigned int vertexCount, unsigned int chunkCount, float size,
+							  std::vector<PositionTexSurfaceVertex>& vert, std::vector<PlaneIndex>& ind,
+							  std::vector<ChunkInfo>& chunkInfo, MeshOptimizer::CacheReport& cacheReport);
 
-Plane::Plane(Material mat, std::vector<PositionTexSurfaceVertex>& vert, std::vector<unsigned int>& ind,
-			 std::vector<ChunkInfo>& chunkInfo) :
-	Model(mat, vert, ind)
+Plane::Plane(Material mat, std::vector<PositionTexSurfaceVertex>& vert, std::vector<PlaneIndex>& ind,
+			 std::vector<ChunkInfo>& chunkInfo, MeshOptimizer::CacheReport cacheReport,
+			 unsigned int vertexCount, unsigned int chunkCount, float size) :
+	Model(mat, vert, ind),
+	gridVertexCount(vertexCount), chunkCount(chunkCount), gridSize(size), chunks(chunkInfo), cacheReport(cacheReport)
 {
 	glGenBuffers(1, &ssboChunkInfo);
 	glBindBuffer(GL_SHADER_STORAGE_BUFFER, ssboChunkInfo);
 	glBufferData(GL_SHADER_STORAGE_BUFFER, chunkInfo.size() * sizeof(ChunkInfo), &chunkInfo[0], GL_DYNAMIC_COPY);
+
+	// baseInstance only reaches instanced attributes in 4.3, so the patch id comes from one
+	std::vector<unsigned int> patchIds(MAX_PATCH_COUNT * MAX_PATCH_COUNT);
+	std::iota(patchIds.begin(), patchIds.end(), 0u);
+	mesh.BindVertexArray();
+	glGenBuffers(1, &patchIdBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, patchIdBuffer);
+	glBufferData(GL_ARRAY_BUFFER, patchIds.size() * sizeof(unsigned int), &patchIds[0], GL_STATIC_DRAW);
+	glVertexAttribIPointer(2, 1, GL_UNSIGNED_INT, sizeof(unsigned int), (void*)0);
+	glEnableVertexAttribArray(2);
+	glVertexAttribDivisor(2, 1);
+
+	glGenBuffers(1, &displacedVertexBuffer);
+	CreateDisplacedVertexBuffer();
+
+	glGenBuffers(1, &drawCommandBuffer);
+	glGenBuffers(1, &commandBuffer);
+	glGenBuffers(1, &cullingStatsBuffer);
+	glGenBuffers(1, &cullingStatsReadbackBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, cullingStatsBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(CullingStats), nullptr, GL_DYNAMIC_COPY);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, cullingStatsReadbackBuffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, sizeof(CullingStats), nullptr, GL_STREAM_READ);
+	CreateCullingBuffers();
+}
+
+void Plane::CreateCullingBuffers()
+{
+	drawInstanceCount = 0;
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+	glBufferData(GL_DRAW_INDIRECT_BUFFER, GetChunkCount() * MAX_PATCH_COUNT * MAX_PATCH_COUNT * sizeof(DrawElementsIndirectCommand),
+				 nullptr, GL_DYNAMIC_COPY);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+void Plane::CreateDisplacedVertexBuffer()
+{
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, displacedVertexBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, GetVertexCount() * sizeof(glm::vec4), nullptr, GL_DYNAMIC_COPY);
 }
 
-void Plane::Recreate(unsigned int vertexCount, unsigned int chunkCount, float size)
+void Plane::Recreate(unsigned int vertexCount, unsigned int newChunkCount, float size)
 {
 	std::vector<PositionTexSurfaceVertex> vert{};
-	std::vector<unsigned int> ind{};
+	std::vector<PlaneIndex> ind{};
 	std::vector<ChunkInfo> chunkInfo{};
-	CalculateXZPlane(vertexCount, chunkCount, size, vert, ind, chunkInfo);
+	chunkCount = CalculateXZPlane(vertexCount, newChunkCount, size, vert, ind, chunkInfo, cacheReport);
+	gridVertexCount = vertexCount;
+	gridSize = size;
+	chunks = chunkInfo;
 
 	mesh.ReplaceData(vert, ind);
 	glBindBuffer(GL_SHADER_STORAGE_BUFFER, ssboChunkInfo);
-	glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, chunkInfo.size() * sizeof(ChunkInfo), &chunkInfo[0]);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, chunkInfo.size() * sizeof(ChunkInfo), &chunkInfo[0], GL_DYNAMIC_COPY);
+	CreateCullingBuffers();
+	CreateDisplacedVertexBuffer();
 }
 
 Plane MakeXZPlane(Material mat, unsigned int vertexCount, unsigned int chunkCount, float size)
 {
 	std::vector<PositionTexSurfaceVertex> vert{};
-	std::vector<unsigned int> ind{};
+	std::vector<PlaneIndex> ind{};
 	std::vector<ChunkInfo> chunkInfo{};
-	CalculateXZPlane(vertexCount, chunkCount, size, vert, ind, chunkInfo);
+	MeshOptimizer::CacheReport cacheReport{};
+	chunkCount = CalculateXZPlane(vertexCount, chunkCount, size, vert, ind, chunkInfo, cacheReport);
+
+	return Plane{ mat, vert, ind, chunkInfo, cacheReport, vertexCount, chunkCount, size };
+}
+
+void Plane::Render(bool ignoreModelMatrix, const char* modelMatrixName)
+{
+	RenderInstanced(1, ignoreModelMatrix, modelMatrixName);
+}
+
+void Plane::RenderInstanced(int instanceCount, bool ignoreModelMatrix, const char* modelMatrixName)
+{
+	material.Set();
+	if (!ignoreModelMatrix)
+		EnableModelMatrix(modelMatrixName);
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, drawCommandBuffer);
+	if (drawInstanceCount != instanceCount)
+	{
+		drawInstanceCount = instanceCount;
+		std::vector<DrawElementsIndirectCommand> commands(chunks.size());
+		std::transform(chunks.begin(), chunks.end(), commands.begin(), [instanceCount](const ChunkInfo& chunk)
+		{
+			return DrawElementsIndirectCommand{ chunk.indexCount, (unsigned int)instanceCount, chunk.indexOffset, chunk.vertexOffset, 0 };
+		});
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, commands.size() * sizeof(DrawElementsIndirectCommand), &commands[0], GL_STATIC_DRAW);
+	}
 
-	return Plane{ mat, vert, ind, chunkInfo };
+	mesh.BindVertexArray();
+	glMultiDrawElementsIndirect(GL_TRIANGLES, Mesh<PositionTexSurfaceVertex, PlaneIndex>::INDEX_GL_TYPE, (void*)0, (GLsizei)chunks.size(), 0);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
 }
 
 void Plane::BindSSBOs(int bindingVertex, int bindingIndex, int bindingModelInfo)
@@ -49,69 +132,184 @@ void Plane::BindChunkInfoSSBO(int bindingModelInfo)
 	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, bindingModelInfo, ssboChunkInfo);
 }
 
-void CalculateXZPlane(unsigned int vertexCount, unsigned int chunkCount, float size,
-					  std::vector<PositionTexSurfaceVertex>& vert, std::vector<unsigned int>& ind,
-					  std::vector<ChunkInfo>& chunkInfo)
+void Plane::BindDisplacedVertexSSBO(int bindingDisplacedVertex)
+{
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, bindingDisplacedVertex, displacedVertexBuffer);
+}
+
+void Plane::UpdateDisplacedVertices(GLuint displacementTex, bool useDisplacement, bool ignoreModelMatrix, const char* modelMatrixName)
+{
+	Renderer::UseShader(ShaderMode::ComputeSurfaceDisplaceVertices);
+	if (!ignoreModelMatrix)
+		EnableModelMatrix(modelMatrixName);
+	Renderer::SetTexture2D(GL_TEXTURE0, "displacementTex", displacementTex);
+	Renderer::SetInt("useDisplacement", useDisplacement);
+	BindVertexSSBO(0);
+	BindDisplacedVertexSSBO(1);
+
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+	glDispatchCompute((GetVertexCount() + DISPLACE_WORK_GROUP_SIZE - 1) / DISPLACE_WORK_GROUP_SIZE, 1, 1);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void Plane::UpdateBoundingBoxes(GLuint heightPyramidTex, int heightPyramidLevelCount)
+{
+	Renderer::UseShader(ShaderMode::ComputeSurfaceBoundingBoxes);
+	Renderer::SetTexture2D(GL_TEXTURE0, "heightPyramidTex", heightPyramidTex);
+	Renderer::SetInt("heightPyramidLevelCount", heightPyramidLevelCount);
+	Renderer::SetFloat("gridStart", -gridSize / 2.0f);
+	Renderer::SetFloat("gridSize", gridSize);
+	Renderer::SetUint("chunkCount", GetChunkCount());
+	BindChunkInfoSSBO(0);
+
+	// the pyramid is written with image stores
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+	glDispatchCompute((GetChunkCount() + BOUNDING_BOX_WORK_GROUP_SIZE - 1) / BOUNDING_BOX_WORK_GROUP_SIZE, 1, 1);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void Plane::Cull(int patchCount, bool ignoreModelMatrix, const char* modelMatrixName)
+{
+	culledPatchCount = std::clamp(patchCount, 1, MAX_PATCH_COUNT);
+	unsigned int commandCount = GetChunkCount() * culledPatchCount * culledPatchCount;
+
+	Renderer::UseShader(ShaderMode::ComputeSurfaceCulling);
+	if (!ignoreModelMatrix)
+		EnableModelMatrix(modelMatrixName);
+	Renderer::SetInt("patchCount", culledPatchCount);
+	Renderer::SetUint("chunkCount", GetChunkCount());
+	BindChunkInfoSSBO(0);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, commandBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, cullingStatsBuffer);
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, cullingStatsBuffer);
+	glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+	glDispatchCompute((commandCount + CULLING_WORK_GROUP_SIZE - 1) / CULLING_WORK_GROUP_SIZE, 1, 1);
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+
+	// stats go through a second buffer so reading them never waits on later frames
+	if (cullingStatsFence == nullptr)
+	{
+		glBindBuffer(GL_COPY_READ_BUFFER, cullingStatsBuffer);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, cullingStatsReadbackBuffer);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, sizeof(CullingStats));
+		cullingStatsFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+	else if (glClientWaitSync(cullingStatsFence, 0, 0) != GL_TIMEOUT_EXPIRED)
+	{
+		glDeleteSync(cullingStatsFence);
+		cullingStatsFence = nullptr;
+		glBindBuffer(GL_COPY_READ_BUFFER, cullingStatsReadbackBuffer);
+		glGetBufferSubData(GL_COPY_READ_BUFFER, 0, sizeof(CullingStats), &cullingStats);
+	}
+}
+
+void Plane::RenderCulled(bool ignoreModelMatrix, const char* modelMatrixName)
+{
+	material.Set();
+	if (!ignoreModelMatrix)
+		EnableModelMatrix(modelMatrixName);
+
+	mesh.BindVertexArray();
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+	glMultiDrawElementsIndirect(GL_TRIANGLES, Mesh<PositionTexSurfaceVertex, PlaneIndex>::INDEX_GL_TYPE, (void*)0,
+								GetChunkCount() * culledPatchCount * culledPatchCount, 0);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+unsigned int Plane::GetChunkCount()
+{
+	return chunkCount * chunkCount;
+}
+
+unsigned int CalculateXZPlane(unsigned int vertexCount, unsigned int chunkCount, float size,
+							  std::vector<PositionTexSurfaceVertex>& vert, std::vector<PlaneIndex>& ind,
+							  std::vector<ChunkInfo>& chunkInfo, MeshOptimizer::CacheReport& cacheReport)
 {
 	unsigned int divs = vertexCount - 1;
-	unsigned int verticesPerChunk = vertexCount / chunkCount;
-	unsigned int totalVerticesPerChunk = verticesPerChunk * verticesPerChunk;
+	// every chunk needs at least one cell and few enough vertices for 16-bit indices
+	unsigned int minChunkCount = (divs + Plane::MAX_CHUNK_CELL_COUNT - 1) / Plane::MAX_CHUNK_CELL_COUNT;
+	chunkCount = std::clamp(chunkCount, minChunkCount, divs);
 	float step = size / divs;
 	float start = -size / 2.0f;
 
-	auto getIndex = [chunkCount, verticesPerChunk](unsigned int cx, unsigned int cz, unsigned int iix, unsigned int iiz)
+	// cells are split as evenly as possible, so the last chunk reaches the edge of the grid
+	auto getFirstCell = [divs, chunkCount](unsigned int chunk)
 	{
-		if (iix >= verticesPerChunk)
-		{
-			iix -= verticesPerChunk;
-			cx++;
-		}
-		if (iiz >= verticesPerChunk)
-		{
-			iiz -= verticesPerChunk;
-			cz++;
-		}
-		return iiz + (iix + (cz + cx * chunkCount) * verticesPerChunk) * verticesPerChunk;
+		return chunk * divs / chunkCount;
 	};
 
-	unsigned int i = 0;
-	unsigned int indexOffset = 0;
+	// chunks own their border vertices, so offsets and counts are all known before generating anything
+	chunkInfo.resize(chunkCount * chunkCount);
+	unsigned int vertexOffset = 0, indexOffset = 0;
 	for (unsigned int cx = 0; cx < chunkCount; cx++)
 	{
+		unsigned int firstCellX = getFirstCell(cx), cellCountX = getFirstCell(cx + 1) - firstCellX;
 		for (unsigned int cz = 0; cz < chunkCount; cz++)
 		{
-			for (unsigned int iix = 0; iix < verticesPerChunk; iix++)
+			unsigned int firstCellZ = getFirstCell(cz), cellCountZ = getFirstCell(cz + 1) - firstCellZ;
+			unsigned int chunkVertexCount = (cellCountX + 1) * (cellCountZ + 1);
+			unsigned int chunkIndexCount = 6 * cellCountX * cellCountZ;
+			chunkInfo[cz + cx * chunkCount] = { vertexOffset, chunkVertexCount, indexOffset, chunkIndexCount,
+												start + firstCellX * step, start + (firstCellX + cellCountX) * step,
+												0.0f, 0.0f,
+												start + firstCellZ * step, start + (firstCellZ + cellCountZ) * step,
+												0.0f, 0.0f };
+			vertexOffset += chunkVertexCount;
+			indexOffset += chunkIndexCount;
+		}
+	}
+	vert.resize(vertexOffset);
+	ind.resize(indexOffset);
+
+	std::vector<unsigned int> chunkIds(chunkInfo.size());
+	std::iota(chunkIds.begin(), chunkIds.end(), 0u);
+	std::vector<MeshOptimizer::CacheReport> chunkReports(chunkInfo.size());
+	std::for_each(std::execution::par, chunkIds.begin(), chunkIds.end(), [&](unsigned int chunkId)
+	{
+		const ChunkInfo& chunk = chunkInfo[chunkId];
+		unsigned int firstCellX = getFirstCell(chunkId / chunkCount), cellCountX = getFirstCell(chunkId / chunkCount + 1) - firstCellX;
+		unsigned int firstCellZ = getFirstCell(chunkId % chunkCount), cellCountZ = getFirstCell(chunkId % chunkCount + 1) - firstCellZ;
+		unsigned int rowLength = cellCountZ + 1;
+
+		PositionTexSurfaceVertex* chunkVert = &vert[chunk.vertexOffset];
+		for (unsigned int iix = 0; iix <= cellCountX; iix++)
+		{
+			unsigned int ix = firstCellX + iix;
+			for (unsigned int iiz = 0; iiz <= cellCountZ; iiz++)
 			{
-				unsigned int ix = cx * verticesPerChunk + iix;
-				for (unsigned int iiz = 0; iiz < verticesPerChunk; iiz++)
-				{
-					unsigned int iz = cz * verticesPerChunk + iiz;
-					vert.push_back(PositionTexSurfaceVertex{ glm::vec2{ start + ix * step, start + iz * step },
-															 glm::vec2{ (float)ix / divs, (float)iz / divs } });
-					// TODO: texCoord should use vertexCount but it leads to seams
-					if (ix < divs && iz < divs)
-					{
-						unsigned int j = getIndex(cx, cz, iix + 1, iiz + 1);
-
-						ind.push_back(i);
-						ind.push_back(j);
-						ind.push_back(getIndex(cx, cz, iix + 1, iiz));
-
-						ind.push_back(i);
-						ind.push_back(getIndex(cx, cz, iix, iiz + 1));
-						ind.push_back(j);
-					}
-					i++;
-				}
+				unsigned int iz = firstCellZ + iiz;
+				// TODO: texCoord should use vertexCount but it leads to seams
+				chunkVert[iiz + iix * rowLength] = PositionTexSurfaceVertex{ glm::vec2{ start + ix * step, start + iz * step },
+																			 glm::vec2{ (float)ix / divs, (float)iz / divs } };
 			}
-			unsigned int indexSize = (unsigned int)ind.size();
-			// TODO: sometimes we might miss a hit because bounding boxes won't include heights at borders of chunks (cx + 1, cz) and (cx, cz + 1)
-			chunkInfo.push_back({(unsigned int)vert.size() - totalVerticesPerChunk, totalVerticesPerChunk,
-								indexOffset, indexSize - indexOffset,
-								start + cx * verticesPerChunk * step, start + ((cx + 1) * verticesPerChunk - (cx == chunkCount - 1 ? 1 : 0)) * step,
-								0.0f, 0.0f,
-								start + cz * verticesPerChunk * step, start + ((cz + 1) * verticesPerChunk - (cz == chunkCount - 1 ? 1 : 0)) * step });
-			indexOffset = indexSize;
 		}
-	}
+
+		PlaneIndex* chunkInd = &ind[chunk.indexOffset];
+		for (unsigned int iix = 0; iix < cellCountX; iix++)
+		{
+			for (unsigned int iiz = 0; iiz < cellCountZ; iiz++)
+			{
+				PlaneIndex i = iiz + iix * rowLength;
+				PlaneIndex j = i + rowLength + 1;
+
+				*chunkInd++ = i;
+				*chunkInd++ = j;
+				*chunkInd++ = i + rowLength;
+
+				*chunkInd++ = i;
+				*chunkInd++ = i + 1;
+				*chunkInd++ = j;
+			}
+		}
+
+		// the row by row order misses the vertex cache on almost every new row
+		chunkReports[chunkId] = MeshOptimizer::Optimize(chunkVert, &ind[chunk.indexOffset], chunk.indexCount, chunk.vertexCount);
+	});
+
+	cacheReport = {};
+	for (const auto& chunkReport : chunkReports)
+		cacheReport += chunkReport;
+
+	return chunkCount;
 }
\ No newline at end of file
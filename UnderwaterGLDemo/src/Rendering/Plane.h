@@ -5,9 +5,11 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
+#include "MeshOptimizer.h"
 #include "Model.h"
 #include "Vertices.h"
 
+// offsets and counts are in vertices and indices, chunk indices are relative to vertexOffset
 struct ChunkInfo
 {
 	unsigned int vertexOffset, vertexCount;
@@ -15,19 +17,81 @@ struct ChunkInfo
 	float minX, maxX;
 	float minY, maxY;
 	float minZ, maxZ;
+	float marginX, marginZ; // horizontal displacement reach, the XZ bounds are for the undisplaced grid
 };
 
-class Plane : public Model<PositionTexSurfaceVertex>
+// layout expected by glMultiDrawElementsIndirect
+struct DrawElementsIndirectCommand
 {
+	unsigned int count;
+	unsigned int instanceCount;
+	unsigned int firstIndex;
+	unsigned int baseVertex;
+	unsigned int baseInstance;
+};
+
+using PlaneIndex = unsigned short;
+
+class Plane : public Model<PositionTexSurfaceVertex, PlaneIndex>
+{
+public:
+	static const int MAX_PATCH_COUNT = 9; // in one dimension
+	static const unsigned int MAX_CHUNK_CELL_COUNT = 255; // in one dimension, keeps chunk vertices addressable by PlaneIndex
+
+	struct CullingStats
+	{
+		unsigned int visibleChunks;
+		unsigned int visibleIndices;
+	};
+
 private:
 	GLuint ssboChunkInfo;
+	GLuint patchIdBuffer;
+	GLuint displacedVertexBuffer;
+	GLuint drawCommandBuffer;
+	int drawInstanceCount = 0;
+	GLuint commandBuffer, cullingStatsBuffer, cullingStatsReadbackBuffer;
+	GLsync cullingStatsFence = nullptr;
+	CullingStats cullingStats{};
+
+	unsigned int gridVertexCount, chunkCount;
+	float gridSize;
+	int culledPatchCount = 1;
+
+	std::vector<ChunkInfo> chunks;
+	MeshOptimizer::CacheReport cacheReport;
+
+	void CreateCullingBuffers();
+	void CreateDisplacedVertexBuffer();
 public:
-	Plane(Material mat, std::vector<PositionTexSurfaceVertex>& vert, std::vector<unsigned int>& ind,
-		  std::vector<ChunkInfo>& chunkInfo);
+	Plane(Material mat, std::vector<PositionTexSurfaceVertex>& vert, std::vector<PlaneIndex>& ind,
+		  std::vector<ChunkInfo>& chunkInfo, MeshOptimizer::CacheReport cacheReport,
+		  unsigned int vertexCount, unsigned int chunkCount, float size = 1.0f);
 	void Recreate(unsigned int vertexCount, unsigned int chunkCount, float size = 1.0f);
+	// every chunk is its own draw with its vertexOffset as the base vertex
+	void Render(bool ignoreModelMatrix = false, const char* modelMatrixName = "M");
+	void RenderInstanced(int instanceCount, bool ignoreModelMatrix = false, const char* modelMatrixName = "M");
 	using Model::BindSSBOs;
 	void BindSSBOs(int bindingVertex, int bindingIndex, int bindingChunkInfo);
 	void BindChunkInfoSSBO(int bindingChunkInfo);
+	void BindDisplacedVertexSSBO(int bindingDisplacedVertex);
+
+	// writes every vertex once per frame as a world-space vec4, for surfaceBuffered shaders and ray casting
+	void UpdateDisplacedVertices(GLuint displacementTex, bool useDisplacement, bool ignoreModelMatrix = false, const char* modelMatrixName = "M");
+
+	// refreshes the Y bounds in the chunk info from the current displacement
+	void UpdateBoundingBoxes(GLuint heightPyramidTex, int heightPyramidLevelCount);
+	// writes one draw command per (patch, chunk), culled ones get zero instances
+	void Cull(int patchCount, bool ignoreModelMatrix = false, const char* modelMatrixName = "M");
+	// draws the result of the last Cull, expects a surfaceCulled* shader
+	void RenderCulled(bool ignoreModelMatrix = false, const char* modelMatrixName = "M");
+
+	unsigned int GetChunkCount();
+	inline float GetGridSize() { return gridSize; }
+	// stats of an earlier frame, picked up once the GPU is done with them
+	inline CullingStats GetCullingStats() { return cullingStats; }
+	// summed over all chunks, before and after reordering
+	inline MeshOptimizer::CacheReport GetCacheReport() { return cacheReport; }
 };
 
 Plane MakeXZPlane(Material mat, unsigned int vertexCount, unsigned int chunkCount, float size = 1.0f);
\ No newline at end of file
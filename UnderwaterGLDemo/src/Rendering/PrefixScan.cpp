@@ -0,0 +1,47 @@
+#include "PrefixScan.h"
+
+#include "Renderer.h"
+
+void PrefixScan::Scan(GLuint buffer, unsigned int elementCount)
+{
+	if (elementCount == 0)
+		return;
+	ScanLevel(buffer, elementCount, 0);
+}
+
+void PrefixScan::ScanLevel(GLuint buffer, unsigned int elementCount, size_t level)
+{
+	unsigned int blockCount = (elementCount + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	if (level == blockSumBuffers.size())
+	{
+		GLuint blockSumBuffer;
+		glGenBuffers(1, &blockSumBuffer);
+		blockSumBuffers.push_back(blockSumBuffer);
+		blockSumCapacities.push_back(0);
+	}
+	if (blockSumCapacities[level] < blockCount)
+	{
+		blockSumCapacities[level] = blockCount;
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, blockSumBuffers[level]);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, blockCount * sizeof(unsigned int), nullptr, GL_DYNAMIC_COPY);
+	}
+
+	Renderer::UseShader(ShaderMode::ComputePrefixScan);
+	Renderer::SetUint("elementCount", elementCount);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, buffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, blockSumBuffers[level]);
+	glDispatchCompute(blockCount, 1, 1);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+	// a single block is already complete, its offset is zero
+	if (blockCount == 1)
+		return;
+
+	ScanLevel(blockSumBuffers[level], blockCount, level + 1);
+
+	Renderer::UseShader(ShaderMode::ComputePrefixScanAdd);
+	Renderer::SetUint("elementCount", elementCount);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, buffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, blockSumBuffers[level]);
+	glDispatchCompute(blockCount, 1, 1);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
\ No newline at end of file
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <vector>
+
+#include <glad/glad.h>
+
+// exclusive scan of uints on the GPU, every block of BLOCK_SIZE is scanned by its own work group,
+// the block totals are scanned recursively and added back, so any length keeps the whole GPU busy
+class PrefixScan
+{
+public:
+	static const unsigned int BLOCK_SIZE = 1024; // local size of prefixScan.comp and prefixScanAdd.comp
+
+private:
+	std::vector<GLuint> blockSumBuffers; // one per level
+	std::vector<unsigned int> blockSumCapacities;
+
+	void ScanLevel(GLuint buffer, unsigned int elementCount, size_t level);
+
+public:
+	// in place over the first elementCount values of buffer, uses bindings 0 and 1
+	void Scan(GLuint buffer, unsigned int elementCount);
+};
\ No newline at end of file
@@ -0,0 +1,57 @@
+#include "ProceduralPlane.h"
+
+#include "Renderer.h"
+#include <glm/gtc/matrix_transform.hpp>
+
+ProceduralPlane::ProceduralPlane(Material mat, unsigned int vertexCount)
+	: material(mat), cellCount(vertexCount - 1), position{}, scale{ 1.0f }
+{
+	// core profile still needs a bound VAO, even an empty one
+	glGenVertexArrays(1, &vao);
+}
+
+void ProceduralPlane::Recreate(unsigned int vertexCount)
+{
+	cellCount = vertexCount - 1;
+}
+
+void ProceduralPlane::RenderInstanced(int instanceCount, bool ignoreModelMatrix, const char* modelMatrixName)
+{
+	material.Set();
+	if (!ignoreModelMatrix)
+		EnableModelMatrix(modelMatrixName);
+	Renderer::SetInt("gridCellCount", cellCount);
+
+	glBindVertexArray(vao);
+	glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 2 * (cellCount + 1), cellCount * instanceCount);
+}
+
+void ProceduralPlane::EnableModelMatrix(const char* modelMatrixName)
+{
+	glm::mat4 M{ 1.0f };
+	M = glm::translate(M, position);
+	M = glm::scale(M, glm::vec3{ scale });
+
+	Renderer::SetMat4(modelMatrixName, M);
+}
+
+void ProceduralPlane::SetColor(float newCol[3])
+{
+	material.ambientColor = glm::vec3(newCol[0], newCol[1], newCol[2]);
+}
+
+void ProceduralPlane::SetScale(float newScale)
+{
+	scale = newScale;
+}
+
+unsigned int ProceduralPlane::GetVertexCount()
+{
+	return (cellCount + 1) * (cellCount + 1);
+}
+
+unsigned int ProceduralPlane::GetTriangleCount(int instanceCount)
+{
+	// one strip of 2 * cellCount triangles per row
+	return 2 * cellCount * cellCount * instanceCount;
+}
\ No newline at end of file
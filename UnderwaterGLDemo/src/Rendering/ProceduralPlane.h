@@ -0,0 +1,30 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "Material.h"
+
+// water grid without vertex or index buffers, the vertex shader builds it from gl_VertexID and gl_InstanceID
+// every grid row is one instanced triangle strip
+class ProceduralPlane
+{
+private:
+	GLuint vao;
+	Material material;
+	unsigned int cellCount;
+
+	glm::vec3 position;
+	float scale;
+public:
+	ProceduralPlane(Material mat, unsigned int vertexCount);
+	void Recreate(unsigned int vertexCount);
+	void RenderInstanced(int instanceCount, bool ignoreModelMatrix = false, const char* modelMatrixName = "M");
+	void EnableModelMatrix(const char* modelMatrixName = "M");
+
+	void SetColor(float newCol[3]);
+	void SetScale(float newScale);
+
+	unsigned int GetVertexCount();
+	unsigned int GetTriangleCount(int instanceCount);
+};
\ No newline at end of file
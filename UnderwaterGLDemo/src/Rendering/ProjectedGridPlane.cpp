@@ -0,0 +1,72 @@
+#include <algorithm>
+
+#include "ProjectedGridPlane.h"
+
+#include "Renderer.h"
+#include <glm/gtc/matrix_transform.hpp>
+
+ProjectedGridPlane::ProjectedGridPlane(Material mat, int gridWidth, int gridHeight, float margin)
+	: material(mat), margin(margin), position{}, scale{ 1.0f }
+{
+	glGenVertexArrays(1, &vao);
+	Recreate(gridWidth, gridHeight);
+}
+
+void ProjectedGridPlane::Recreate(int newGridWidth, int newGridHeight)
+{
+	gridWidth = std::clamp(newGridWidth, MIN_RESOLUTION, MAX_RESOLUTION);
+	gridHeight = std::clamp(newGridHeight, MIN_RESOLUTION, MAX_RESOLUTION);
+}
+
+void ProjectedGridPlane::Render(glm::vec3 cameraPos, float maxDistance, bool ignoreModelMatrix, const char* modelMatrixName)
+{
+	material.Set();
+	if (!ignoreModelMatrix)
+		EnableModelMatrix(modelMatrixName);
+
+	// the shader works in surface units, the model matrix brings the result back to world space
+	glm::vec3 localCameraPos = (cameraPos - position) / scale;
+	Renderer::SetInt("projectedGridWidth", gridWidth);
+	Renderer::SetInt("projectedGridHeight", gridHeight);
+	Renderer::SetFloat("projectedGridMargin", margin);
+	Renderer::SetFloat("projectedGridMaxDistance", maxDistance / scale);
+	Renderer::SetVec3("projectedGridCamera", localCameraPos);
+
+	glBindVertexArray(vao);
+	glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 2 * gridWidth, gridHeight - 1);
+}
+
+void ProjectedGridPlane::EnableModelMatrix(const char* modelMatrixName)
+{
+	glm::mat4 M{ 1.0f };
+	M = glm::translate(M, position);
+	M = glm::scale(M, glm::vec3{ scale });
+
+	Renderer::SetMat4(modelMatrixName, M);
+}
+
+void ProjectedGridPlane::SetColor(float newCol[3])
+{
+	material.ambientColor = glm::vec3(newCol[0], newCol[1], newCol[2]);
+}
+
+void ProjectedGridPlane::SetScale(float newScale)
+{
+	scale = newScale;
+}
+
+void ProjectedGridPlane::SetMargin(float newMargin)
+{
+	margin = newMargin;
+}
+
+unsigned int ProjectedGridPlane::GetVertexCount()
+{
+	return gridWidth * gridHeight;
+}
+
+unsigned int ProjectedGridPlane::GetTriangleCount()
+{
+	// one strip per row of quads
+	return 2 * (gridWidth - 1) * (gridHeight - 1);
+}
\ No newline at end of file
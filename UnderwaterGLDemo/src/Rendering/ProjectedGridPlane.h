@@ -0,0 +1,35 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "Material.h"
+
+// screen-space grid projected onto the sea plane every frame, so vertex density follows pixel density up to the horizon
+class ProjectedGridPlane
+{
+public:
+	static const int MIN_RESOLUTION = 16;
+	static const int MAX_RESOLUTION = 1024;
+
+private:
+	GLuint vao;
+	Material material;
+	int gridWidth, gridHeight;
+	float margin;
+
+	glm::vec3 position;
+	float scale;
+public:
+	ProjectedGridPlane(Material mat, int gridWidth, int gridHeight, float margin = 0.1f);
+	void Recreate(int newGridWidth, int newGridHeight);
+	void Render(glm::vec3 cameraPos, float maxDistance, bool ignoreModelMatrix = false, const char* modelMatrixName = "M");
+	void EnableModelMatrix(const char* modelMatrixName = "M");
+
+	void SetColor(float newCol[3]);
+	void SetScale(float newScale);
+	void SetMargin(float newMargin);
+
+	unsigned int GetVertexCount();
+	unsigned int GetTriangleCount();
+};
\ No newline at end of file
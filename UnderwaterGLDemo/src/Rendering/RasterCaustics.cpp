@@ -0,0 +1,50 @@
+#include <algorithm>
+
+#include "RasterCaustics.h"
+
+#include "Renderer.h"
+
+RasterCaustics::RasterCaustics(int cellCount)
+{
+	// the grid comes from gl_VertexID like ProceduralPlane, the VAO stays empty
+	glGenVertexArrays(1, &vao);
+	Recreate(cellCount);
+}
+
+void RasterCaustics::Recreate(int newCellCount)
+{
+	cellCount = std::clamp(newCellCount, MIN_CELL_COUNT, MAX_CELL_COUNT);
+}
+
+void RasterCaustics::Render(CausticMap& causticMap, GLuint displacementTex, GLuint normalTex, glm::mat4 surfaceM, int patchCount,
+							bool useDisplacement, float receiverHeight, float lightIntensity)
+{
+	// the caller's viewport has to survive, it's only set once for the window
+	GLint prevViewport[4];
+	glGetIntegerv(GL_VIEWPORT, prevViewport);
+
+	Renderer::UseShader(ShaderMode::CausticRaster);
+	causticMap.BindFramebuffer();
+	Renderer::SetTexture2D(GL_TEXTURE0, "displacementTex", displacementTex);
+	Renderer::SetTexture2D(GL_TEXTURE1, "normalTex", normalTex);
+	Renderer::SetMat4("M", surfaceM);
+	Renderer::SetInt("patchCount", patchCount);
+	Renderer::SetInt("gridCellCount", cellCount);
+	Renderer::SetInt("useDisplacement", useDisplacement);
+	Renderer::SetFloat("receiverHeight", receiverHeight);
+	Renderer::SetFloat("lightIntensity", lightIntensity);
+
+	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+	glClear(GL_COLOR_BUFFER_BIT);
+	glDisable(GL_DEPTH_TEST);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_ONE, GL_ONE);
+
+	glBindVertexArray(vao);
+	glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 2 * (cellCount + 1), cellCount * patchCount * patchCount);
+
+	glDisable(GL_BLEND);
+	glEnable(GL_DEPTH_TEST);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(prevViewport[0], prevViewport[1], prevViewport[2], prevViewport[3]);
+}
\ No newline at end of file
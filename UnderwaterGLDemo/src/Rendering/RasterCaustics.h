@@ -0,0 +1,30 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "CausticMap.h"
+
+// caustics without ray casting, a grid over the water patches is refracted vertex by vertex onto a horizontal receiver
+// every triangle is rasterised additively into the caustic map with the ratio of its water area to its receiver area
+class RasterCaustics
+{
+public:
+	static const int MIN_CELL_COUNT = 16;
+	static const int MAX_CELL_COUNT = 1024;
+
+private:
+	GLuint vao;
+	int cellCount;
+
+public:
+	RasterCaustics(int cellCount);
+	void Recreate(int newCellCount);
+	// displacementTex and normalTex are the surface's, surfaceM the water plane's model matrix
+	// lightIntensity is the flux per steradian of the current light
+	void Render(CausticMap& causticMap, GLuint displacementTex, GLuint normalTex, glm::mat4 surfaceM, int patchCount,
+				bool useDisplacement, float receiverHeight, float lightIntensity);
+
+	inline int GetCellCount() { return cellCount; }
+	inline unsigned int GetTriangleCount(int patchCount) { return 2 * cellCount * cellCount * patchCount * patchCount; }
+};
\ No newline at end of file
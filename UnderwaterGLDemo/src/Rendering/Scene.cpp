@@ -1,8 +1,10 @@
 #include <filesystem>
 #include <fstream>
 #include <map>
+#include <numeric>
 #include <string>
 #include <sstream>
+#include <tuple>
 
 #include "Scene.h"
 
@@ -15,6 +17,28 @@ struct ModelInfo
 	// TODO: material data
 };
 
+// std430 layout shared with photonTrace.glsl, Moller-Trumbore only needs the first corner and the two edges
+struct RayTriangle
+{
+	glm::vec4 v0;
+	glm::vec4 edge1;
+	glm::vec4 edge2;
+};
+
+static std::vector<RayTriangle> GetRayTriangles(const std::vector<PositionNormalTexVertex>& vertices, const std::vector<unsigned int>& indices)
+{
+	std::vector<RayTriangle> triangles;
+	triangles.reserve(indices.size() / 3);
+	for (size_t i = 0; i + 2 < indices.size(); i += 3)
+	{
+		glm::vec3 v0 = vertices[indices[i]].position;
+		glm::vec3 v1 = vertices[indices[i + 1]].position;
+		glm::vec3 v2 = vertices[indices[i + 2]].position;
+		triangles.push_back({ glm::vec4{ v0, 1.0f }, glm::vec4{ v1 - v0, 0.0f }, glm::vec4{ v2 - v0, 0.0f } });
+	}
+	return triangles;
+}
+
 Scene::Scene(const char* objPath)
 	: position{}, rotation{}, scale{ 1.0f }
 {
@@ -75,10 +99,11 @@ Scene::Scene(const char* objPath)
 	std::vector<glm::vec2> texCoords, curTexCoords;
 	std::vector<glm::vec3> positions, normals, curPositions, curNormals;
 	std::vector<unsigned int> curIndices;
+	// corners with the same position, texture coordinate and normal share one vertex
+	std::map<std::tuple<int, int, int>, unsigned int> curVertexMap;
 	float minX = FLT_MAX, maxX = -FLT_MAX;
 	float minY = FLT_MAX, maxY = -FLT_MAX;
 	float minZ = FLT_MAX, maxZ = -FLT_MAX;
-	int curIndex = 0, readIndex = 0;
 
 	std::vector<PositionNormalTexVertex> allVertices;
 	std::vector<unsigned int> allIndices;
@@ -90,11 +115,23 @@ Scene::Scene(const char* objPath)
 		if (!curIndices.empty())
 		{
 			std::vector<PositionNormalTexVertex> curVertices;
+			curVertices.reserve(curPositions.size());
 			for (int i = 0; i < curPositions.size(); i++)
 			{
-				PositionNormalTexVertex newVertex{ curPositions[i], curNormals[i], curTexCoords[i] };
-				curVertices.push_back(newVertex);
-				allVertices.push_back(newVertex);
+				curVertices.push_back(PositionNormalTexVertex{ curPositions[i], curNormals[i], curTexCoords[i] });
+			}
+
+			MeshOptimizer::CacheReport cacheReport = MeshOptimizer::Optimize(curVertices.data(), curIndices.data(), curIndices.size(), curVertices.size());
+			// the baseline is the old loader output, one vertex per face corner
+			std::vector<unsigned int> cornerIndices(curIndices.size());
+			std::iota(cornerIndices.begin(), cornerIndices.end(), 0u);
+			cacheReport.before = MeshOptimizer::AnalyzeVertexCache(cornerIndices.data(), cornerIndices.size(), cornerIndices.size());
+			cacheReports.push_back(cacheReport);
+
+			allVertices.insert(allVertices.end(), curVertices.begin(), curVertices.end());
+			for (unsigned int index : curIndices)
+			{
+				allIndices.push_back(index + allIndicesCurShift);
 			}
 			auto curModel = std::make_unique<Model<PositionNormalTexVertex>>(curMat, curVertices, curIndices);
 			models.push_back(std::move(curModel));
@@ -107,7 +144,7 @@ Scene::Scene(const char* objPath)
 			curNormals.clear();
 			curTexCoords.clear();
 			curIndices.clear();
-			curIndex = 0;
+			curVertexMap.clear();
 			minX = minY = minZ = FLT_MAX;
 			maxX = maxY = maxZ = -FLT_MAX;
 		}
@@ -145,8 +182,22 @@ Scene::Scene(const char* objPath)
 		{
 			for (int i = 0; i < 3; i++)
 			{
-				lineStream >> readIndex;
-				glm::vec3 pos = positions[readIndex - 1];
+				int positionIndex = 0, texCoordIndex = 0, normalIndex = 0;
+				lineStream >> positionIndex;
+				lineStream.ignore(1);
+				if (lineStream.peek() != '/')
+				{
+					lineStream >> texCoordIndex;
+				}
+				lineStream.ignore(1);
+				lineStream >> normalIndex;
+
+				auto [vertexIt, isNew] = curVertexMap.try_emplace({ positionIndex, texCoordIndex, normalIndex }, (unsigned int)curPositions.size());
+				curIndices.push_back(vertexIt->second);
+				if (!isNew)
+					continue;
+
+				glm::vec3 pos = positions[positionIndex - 1];
 				curPositions.push_back(pos);
 
 				minX = std::min(minX, pos.x);
@@ -157,40 +208,44 @@ Scene::Scene(const char* objPath)
 				maxY = std::max(maxY, pos.y);
 				maxZ = std::max(maxZ, pos.z);
 
-				lineStream.ignore(1);
-				if (lineStream.peek() != '/')
-				{
-					lineStream >> readIndex;
-					curTexCoords.push_back(texCoords[readIndex - 1]);
-				}
-				else
-				{
-					curTexCoords.push_back(glm::vec2{ 0 });
-				}
-				lineStream.ignore(1);
-				lineStream >> readIndex;
-				curNormals.push_back(normals[readIndex - 1]);
-
-				unsigned int newIndex = curIndex++;
-				curIndices.push_back(newIndex);
-				allIndices.push_back(newIndex + allIndicesCurShift);
+				curTexCoords.push_back(texCoordIndex > 0 ? texCoords[texCoordIndex - 1] : glm::vec2{ 0 });
+				curNormals.push_back(normals[normalIndex - 1]);
 			}
 		}
 	}
 	createModelIfExists();
 	objFile.close();
 
-	glGenBuffers(1, &ssboVertices);
-	glBindBuffer(GL_SHADER_STORAGE_BUFFER, ssboVertices);
-	glBufferData(GL_SHADER_STORAGE_BUFFER, allVertices.size() * sizeof(PositionNormalTexVertex), &allVertices[0], GL_DYNAMIC_COPY);
-
-	glGenBuffers(1, &ssboIndices);
-	glBindBuffer(GL_SHADER_STORAGE_BUFFER, ssboIndices);
-	glBufferData(GL_SHADER_STORAGE_BUFFER, allIndices.size() * sizeof(unsigned int), &allIndices[0], GL_DYNAMIC_COPY);
+	// rays only need positions, so the vertices are resolved once here instead of two fetches per corner in every test
+	// everything stays in object space, instances carry the transform and move the ray instead
+	std::vector<RayTriangle> triangles = GetRayTriangles(allVertices, allIndices);
+	glGenBuffers(1, &ssboTriangles);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, ssboTriangles);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, triangles.size() * sizeof(RayTriangle), triangles.data(), GL_STATIC_DRAW);
 
 	glGenBuffers(1, &ssboModelInfo);
 	glBindBuffer(GL_SHADER_STORAGE_BUFFER, ssboModelInfo);
 	glBufferData(GL_SHADER_STORAGE_BUFFER, allModelInfo.size() * sizeof(ModelInfo), &allModelInfo[0], GL_DYNAMIC_COPY);
+
+	// the hierarchy gets its own copy of the triangles, reordered so leaves are contiguous
+	std::vector<glm::vec3> allPositions;
+	allPositions.reserve(allVertices.size());
+	for (const PositionNormalTexVertex& vertex : allVertices)
+		allPositions.push_back(vertex.position);
+	std::vector<Bvh::Node> bvhNodes;
+	std::vector<unsigned int> bvhIndices;
+	bvhStats = Bvh::Build(allPositions, allIndices, bvhNodes, bvhIndices);
+	boundsMin = glm::vec3{ bvhNodes[0].minX, bvhNodes[0].minY, bvhNodes[0].minZ };
+	boundsMax = glm::vec3{ bvhNodes[0].maxX, bvhNodes[0].maxY, bvhNodes[0].maxZ };
+
+	glGenBuffers(1, &ssboBvhNodes);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, ssboBvhNodes);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, bvhNodes.size() * sizeof(Bvh::Node), &bvhNodes[0], GL_STATIC_DRAW);
+
+	std::vector<RayTriangle> bvhTriangles = GetRayTriangles(allVertices, bvhIndices);
+	glGenBuffers(1, &ssboBvhTriangles);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, ssboBvhTriangles);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, bvhTriangles.size() * sizeof(RayTriangle), bvhTriangles.data(), GL_STATIC_DRAW);
 }
 
 void Scene::SetPosition(float newPos[3])
@@ -205,24 +260,39 @@ void Scene::SetScale(float newScale)
 
 void Scene::Render()
 {
-	EnableSceneModelMatrix();
+	Render(GetModelMatrix());
+}
+
+void Scene::Render(glm::mat4 M)
+{
+	Renderer::SetMat4("M", M);
 	for (int i = 0; i < models.size(); i++)
 		models[i]->Render(true);
 }
 
 void Scene::EnableSceneModelMatrix()
+{
+	glm::mat4 M = GetModelMatrix();
+	Renderer::SetMat4("M", M);
+}
+
+glm::mat4 Scene::GetModelMatrix()
 {
 	// TODO: rotation
 	glm::mat4 M{ 1.0f };
 	M = glm::translate(M, position);
 	M = glm::scale(M, glm::vec3{ scale });
-
-	Renderer::SetMat4("M", M);
+	return M;
 }
 
-void Scene::BindSSBOs(int bindingVertex, int bindingIndex, int bindingModelInfo)
+void Scene::BindSSBOs(int bindingTriangle, int bindingModelInfo)
 {
-	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, bindingVertex, ssboVertices);
-	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, bindingIndex, ssboIndices);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, bindingTriangle, ssboTriangles);
 	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, bindingModelInfo, ssboModelInfo);
+}
+
+void Scene::BindBvhSSBOs(int bindingNode, int bindingTriangle)
+{
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, bindingNode, ssboBvhNodes);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, bindingTriangle, ssboBvhTriangles);
 }
\ No newline at end of file
@@ -2,14 +2,20 @@
 
 #include <vector>
 
+#include "Bvh.h"
+#include "MeshOptimizer.h"
 #include "Model.h"
 
 class Scene
 {
 private:
-	GLuint ssboVertices, ssboIndices, ssboModelInfo;
+	GLuint ssboTriangles, ssboModelInfo; // object space v0 and edges, one per triangle in model order
+	GLuint ssboBvhNodes, ssboBvhTriangles; // same triangles in leaf order
 public:
 	std::vector<std::unique_ptr<Model<PositionNormalTexVertex>>> models;
+	std::vector<MeshOptimizer::CacheReport> cacheReports; // one per model, "before" is the loader's one-vertex-per-corner order
+	Bvh::BuildStats bvhStats; // over all models, in object space
+	glm::vec3 boundsMin, boundsMax; // object space, the root of the BVH
 	glm::vec3 position;
 	glm::vec3 rotation;
 	float scale;
@@ -19,6 +25,10 @@ public:
 	void SetPosition(float newPos[3]);
 	void SetScale(float newScale);
 	void Render();
+	// draws one copy with its own model matrix, for instances placed around the scene
+	void Render(glm::mat4 M);
 	void EnableSceneModelMatrix();
-	void BindSSBOs(int bindingVertex, int bindingIndex, int bindingModelInfo);
+	glm::mat4 GetModelMatrix();
+	void BindSSBOs(int bindingTriangle, int bindingModelInfo);
+	void BindBvhSSBOs(int bindingNode, int bindingTriangle);
 };
\ No newline at end of file
@@ -0,0 +1,85 @@
+#include <algorithm>
+#include <cfloat>
+
+#include "SceneHeightfield.h"
+
+#include "Renderer.h"
+
+SceneHeightfield::SceneHeightfield(int resolution)
+{
+	glGenFramebuffers(1, &framebuffer);
+	glGenRenderbuffers(1, &depth);
+	Recreate(resolution);
+}
+
+void SceneHeightfield::Recreate(int newResolution)
+{
+	if (newResolution == resolution)
+		return;
+	resolution = newResolution;
+	valid = false;
+
+	glDeleteTextures(1, &heightTex);
+	heightTex = Renderer::CreateTexture2D(resolution, resolution, GL_RGBA32F, GL_RGBA, GL_FLOAT, nullptr);
+
+	glBindRenderbuffer(GL_RENDERBUFFER, depth);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, resolution, resolution);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, heightTex, 0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+bool SceneHeightfield::NeedsUpdate(CausticMap& causticMap, const std::vector<glm::mat4>& newReceiverMatrices, glm::vec3 boundsMin,
+								   glm::vec3 boundsMax)
+{
+	if (valid && regionMin == causticMap.GetRegionMin() && regionSize == causticMap.GetRegionSize() &&
+		receiverMatrices == newReceiverMatrices)
+		return false;
+
+	regionMin = causticMap.GetRegionMin();
+	regionSize = causticMap.GetRegionSize();
+	receiverMatrices = newReceiverMatrices;
+	minHeight = FLT_MAX;
+	for (const glm::mat4& M : receiverMatrices)
+	{
+		for (int corner = 0; corner < 8; corner++)
+		{
+			glm::vec3 cornerPos{ corner & 1 ? boundsMax.x : boundsMin.x, corner & 2 ? boundsMax.y : boundsMin.y,
+								 corner & 4 ? boundsMax.z : boundsMin.z };
+			minHeight = std::min(minHeight, (M * glm::vec4{ cornerPos, 1.0f }).y);
+		}
+	}
+	return true;
+}
+
+void SceneHeightfield::Begin(CausticMap& causticMap)
+{
+	glGetIntegerv(GL_VIEWPORT, prevViewport);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glViewport(0, 0, resolution, resolution);
+	// texels without a receiver sit below everything, rays pass them until they leave the region
+	glClearColor(0.0f, 0.0f, 0.0f, -HEIGHT_RANGE);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	glm::mat4 P = causticMap.GetTopDownProjection(HEIGHT_RANGE);
+	glm::mat4 V{ 1.0f };
+	Renderer::UseShader(ShaderMode::CausticGuide);
+	Renderer::SetMat4("P", P);
+	Renderer::SetMat4("V", V);
+}
+
+void SceneHeightfield::End()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(prevViewport[0], prevViewport[1], prevViewport[2], prevViewport[3]);
+	valid = true;
+}
+
+void SceneHeightfield::SetHeightfieldTexture(GLenum textureUnit, const char* name)
+{
+	Renderer::SetTexture2D(textureUnit, name, heightTex);
+	Renderer::SetVec2("sceneHeightfieldMin", regionMin.x, regionMin.y);
+	Renderer::SetFloat("sceneHeightfieldSize", regionSize);
+	Renderer::SetFloat("sceneHeightfieldMinHeight", minHeight);
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "CausticMap.h"
+
+// top-down heights and normals of the receivers over the caustic region, cached until the receivers or the region move
+// photons heading down after the water march through it instead of tracing the scene, see marchSceneHeightfield
+// the phong pass uses it to keep caustic texels on the receiver they were gathered for
+class SceneHeightfield
+{
+public:
+	static const int MIN_RESOLUTION = 64;
+	static const int MAX_RESOLUTION = 2048;
+	static constexpr float HEIGHT_RANGE = 100.0f; // receivers are expected within this of y = 0
+
+private:
+	GLuint framebuffer, depth;
+	GLuint heightTex = 0;
+	int resolution = 0;
+	bool valid = false;
+	glm::vec2 regionMin{};
+	float regionSize = 1.0f;
+	std::vector<glm::mat4> receiverMatrices;
+	float minHeight = 0.0f; // of all receivers, rays below it can't hit anything
+	GLint prevViewport[4];
+
+public:
+	SceneHeightfield(int resolution);
+	void Recreate(int newResolution);
+	// false while the cached receivers still match, otherwise the receivers have to be rendered between Begin and End
+	// every receiver is one copy of the object space box boundsMin to boundsMax
+	bool NeedsUpdate(CausticMap& causticMap, const std::vector<glm::mat4>& newReceiverMatrices, glm::vec3 boundsMin, glm::vec3 boundsMax);
+	// binds the guide shader, the receivers are drawn with it like for CausticDenoiser::BeginGuide
+	void Begin(CausticMap& causticMap);
+	void End();
+	inline void Invalidate() { valid = false; }
+	// binds the heightfield and its region uniforms for the photon intersect stage or the phong pass
+	void SetHeightfieldTexture(GLenum textureUnit, const char* name);
+
+	inline int GetResolution() { return resolution; }
+};
\ No newline at end of file
@@ -0,0 +1,118 @@
+#include <algorithm>
+
+#include "TessellatedPlane.h"
+
+#include "Renderer.h"
+
+void CalculateXZQuads(unsigned int baseCount, float size,
+					  std::vector<PositionTexSurfaceVertex>& vert, std::vector<unsigned int>& ind);
+
+TessellatedPlane::TessellatedPlane(Material mat, std::vector<PositionTexSurfaceVertex>& vert, std::vector<unsigned int>& ind,
+								   unsigned int baseCount) :
+	Model(mat, vert, ind, GL_PATCHES),
+	baseCount(baseCount)
+{
+	glGetIntegerv(GL_MAX_TESS_GEN_LEVEL, &maxLevel);
+	glGenQueries(1, &primitiveQuery);
+}
+
+void TessellatedPlane::Recreate(unsigned int newBaseCount, float size)
+{
+	std::vector<PositionTexSurfaceVertex> vert{};
+	std::vector<unsigned int> ind{};
+	baseCount = std::clamp(newBaseCount, (unsigned int)MIN_BASE_COUNT, (unsigned int)MAX_BASE_COUNT);
+	CalculateXZQuads(baseCount, size, vert, ind);
+
+	mesh.ReplaceData(vert, ind);
+}
+
+void TessellatedPlane::RenderInstanced(int patchInstanceCount, bool ignoreModelMatrix, const char* modelMatrixName)
+{
+	Renderer::SetFloat("tessEdgeLength", edgeLength);
+	Renderer::SetFloat("tessCurvatureScale", curvatureScale);
+	Renderer::SetFloat("tessMaxLevel", (float)maxLevel);
+	glPatchParameteri(GL_PATCH_VERTICES, 4);
+
+	// picked up without waiting, a draw is only counted when the previous count has arrived
+	if (queryPending)
+	{
+		GLint available = 0;
+		glGetQueryObjectiv(primitiveQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available)
+		{
+			glGetQueryObjectuiv(primitiveQuery, GL_QUERY_RESULT, &generatedTriangleCount);
+			queryPending = false;
+		}
+	}
+	bool countDraw = !queryPending;
+	if (countDraw)
+		glBeginQuery(GL_PRIMITIVES_GENERATED, primitiveQuery);
+	Model::RenderInstanced(patchInstanceCount, ignoreModelMatrix, modelMatrixName);
+	if (countDraw)
+	{
+		glEndQuery(GL_PRIMITIVES_GENERATED);
+		queryPending = true;
+	}
+}
+
+void TessellatedPlane::SetEdgeLength(float newEdgeLength)
+{
+	edgeLength = newEdgeLength;
+}
+
+void TessellatedPlane::SetCurvatureScale(float newCurvatureScale)
+{
+	curvatureScale = newCurvatureScale;
+}
+
+unsigned int TessellatedPlane::GetBaseCount()
+{
+	return baseCount;
+}
+
+unsigned int TessellatedPlane::GetPatchCount()
+{
+	return baseCount * baseCount;
+}
+
+TessellatedPlane MakeTessellatedXZPlane(Material mat, unsigned int baseCount, float size)
+{
+	std::vector<PositionTexSurfaceVertex> vert{};
+	std::vector<unsigned int> ind{};
+	baseCount = std::clamp(baseCount, (unsigned int)TessellatedPlane::MIN_BASE_COUNT, (unsigned int)TessellatedPlane::MAX_BASE_COUNT);
+	CalculateXZQuads(baseCount, size, vert, ind);
+
+	return TessellatedPlane{ mat, vert, ind, baseCount };
+}
+
+void CalculateXZQuads(unsigned int baseCount, float size,
+					  std::vector<PositionTexSurfaceVertex>& vert, std::vector<unsigned int>& ind)
+{
+	unsigned int cornerCount = baseCount + 1;
+	float step = size / baseCount;
+	float start = -size / 2.0f;
+
+	vert.reserve(cornerCount * cornerCount);
+	for (unsigned int ix = 0; ix < cornerCount; ix++)
+	{
+		for (unsigned int iz = 0; iz < cornerCount; iz++)
+		{
+			vert.push_back(PositionTexSurfaceVertex{ glm::vec2{ start + ix * step, start + iz * step },
+													 glm::vec2{ (float)ix / baseCount, (float)iz / baseCount } });
+		}
+	}
+
+	// one 4-vertex patch per quad, the tessellation control shader expects (x0, z0), (x1, z0), (x1, z1), (x0, z1)
+	ind.reserve(4 * baseCount * baseCount);
+	for (unsigned int ix = 0; ix < baseCount; ix++)
+	{
+		for (unsigned int iz = 0; iz < baseCount; iz++)
+		{
+			unsigned int i = iz + ix * cornerCount;
+			ind.push_back(i);
+			ind.push_back(i + cornerCount);
+			ind.push_back(i + cornerCount + 1);
+			ind.push_back(i + 1);
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "Model.h"
+#include "Vertices.h"
+
+// coarse grid of quads drawn as GL_PATCHES, the tessellator adds the detail near the camera and in curved areas
+class TessellatedPlane : public Model<PositionTexSurfaceVertex>
+{
+public:
+	static const int MIN_BASE_COUNT = 4;
+	static const int MAX_BASE_COUNT = 256;
+
+private:
+	unsigned int baseCount;
+	float edgeLength = 16.0f;
+	float curvatureScale = 4.0f;
+	GLint maxLevel;
+	GLuint primitiveQuery;
+	bool queryPending = false;
+	unsigned int generatedTriangleCount = 0;
+public:
+	TessellatedPlane(Material mat, std::vector<PositionTexSurfaceVertex>& vert, std::vector<unsigned int>& ind, unsigned int baseCount);
+	void Recreate(unsigned int baseCount, float size = 1.0f);
+	void RenderInstanced(int patchInstanceCount, bool ignoreModelMatrix = false, const char* modelMatrixName = "M");
+
+	void SetEdgeLength(float newEdgeLength);
+	void SetCurvatureScale(float newCurvatureScale);
+
+	unsigned int GetBaseCount();
+	unsigned int GetPatchCount();
+	// the levels are picked on the GPU, so this comes from a GL_PRIMITIVES_GENERATED query of an earlier draw
+	inline unsigned int GetGeneratedTriangleCount() { return generatedTriangleCount; }
+};
+
+TessellatedPlane MakeTessellatedXZPlane(Material mat, unsigned int baseCount, float size = 1.0f);
\ No newline at end of file
@@ -0,0 +1,73 @@
+#include <algorithm>
+
+#include "TopLevelBvh.h"
+
+#include "Renderer.h"
+
+TopLevelBvh::TopLevelBvh()
+{
+	glGenBuffers(1, &nodeBuffer);
+	glGenBuffers(1, &instanceBuffer);
+}
+
+void TopLevelBvh::Clear()
+{
+	instances.clear();
+	instanceMin.clear();
+	instanceMax.clear();
+}
+
+void TopLevelBvh::AddInstance(unsigned int blas, glm::mat4 objectToWorld, glm::vec3 objectMin, glm::vec3 objectMax)
+{
+	instances.push_back(BvhInstance{ objectToWorld, glm::inverse(objectToWorld), blas, {} });
+
+	glm::vec3 worldMin{ FLT_MAX }, worldMax{ -FLT_MAX };
+	for (int corner = 0; corner < 8; corner++)
+	{
+		glm::vec3 objectCorner{ corner & 1 ? objectMax.x : objectMin.x,
+								corner & 2 ? objectMax.y : objectMin.y,
+								corner & 4 ? objectMax.z : objectMin.z };
+		glm::vec3 worldCorner = glm::vec3(objectToWorld * glm::vec4(objectCorner, 1.0f));
+		worldMin = glm::min(worldMin, worldCorner);
+		worldMax = glm::max(worldMax, worldCorner);
+	}
+	instanceMin.push_back(worldMin);
+	instanceMax.push_back(worldMax);
+}
+
+void TopLevelBvh::Build()
+{
+	std::vector<unsigned int> instanceOrder;
+	stats = Bvh::Build(instanceMin, instanceMax, nodes, instanceOrder);
+
+	// leaves address their instances as one contiguous range
+	std::vector<BvhInstance> orderedInstances;
+	orderedInstances.reserve(instances.size());
+	for (unsigned int instance : instanceOrder)
+		orderedInstances.push_back(instances[instance]);
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, nodeBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, nodes.size() * sizeof(Bvh::Node), nodes.data(), GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, instanceBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, orderedInstances.size() * sizeof(BvhInstance), orderedInstances.data(), GL_DYNAMIC_DRAW);
+}
+
+void TopLevelBvh::Refit(Scene& scene, LinearBvh& waterBvh)
+{
+	if (nodes.empty())
+		return;
+
+	// a handful of nodes, one invocation walks them backwards so children come before their parents
+	Renderer::UseShader(ShaderMode::ComputeTlasRefit);
+	BindSSBOs(0, 1);
+	scene.BindBvhSSBOs(2, 3);
+	waterBvh.BindNodeSSBO(4);
+	glDispatchCompute(1, 1, 1);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void TopLevelBvh::BindSSBOs(int bindingNode, int bindingInstance)
+{
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, bindingNode, nodeBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, bindingInstance, instanceBuffer);
+}
\ No newline at end of file
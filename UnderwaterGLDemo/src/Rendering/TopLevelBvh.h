@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "Bvh.h"
+#include "LinearBvh.h"
+#include "Scene.h"
+
+// std430 layout shared with tlasRefit.comp and photonTrace.glsl
+struct BvhInstance
+{
+	glm::mat4 objectToWorld;
+	glm::mat4 worldToObject;
+	unsigned int blas; // one of TopLevelBvh::BLAS_*
+	unsigned int padding[3];
+};
+
+// two-level hierarchy, the leaves are instances of a bottom-level hierarchy (BLAS) with their own transform
+// rays move into object space once per instance, so moving an instance never touches its BLAS
+class TopLevelBvh
+{
+public:
+	static const unsigned int BLAS_SCENE = 0; // Scene's SAH BVH, in model space
+	static const unsigned int BLAS_WATER = 1; // the water LinearBvh, in world space of the patch at the origin
+
+private:
+	GLuint nodeBuffer, instanceBuffer;
+	std::vector<BvhInstance> instances;
+	std::vector<glm::vec3> instanceMin, instanceMax;
+	std::vector<Bvh::Node> nodes;
+	Bvh::BuildStats stats;
+
+public:
+	TopLevelBvh();
+
+	void Clear();
+	// the object bounds only guide the build, Refit computes the real boxes from the current BLAS roots
+	void AddInstance(unsigned int blas, glm::mat4 objectToWorld, glm::vec3 objectMin, glm::vec3 objectMax);
+	// SAH build over the instances added since Clear, cheap enough to redo every frame
+	void Build();
+	// expects both BLASes to be up to date, the water one is refit every frame
+	void Refit(Scene& scene, LinearBvh& waterBvh);
+	void BindSSBOs(int bindingNode, int bindingInstance);
+
+	inline unsigned int GetInstanceCount() { return (unsigned int)instances.size(); }
+	inline const Bvh::BuildStats& GetStats() { return stats; }
+};
\ No newline at end of file
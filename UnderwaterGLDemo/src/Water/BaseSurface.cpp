@@ -1,7 +1,13 @@
+#include <algorithm>
+#include <string>
+
 #include "../Rendering/Renderer.h"
 
 #include "BaseSurface.h"
 
+const int HEIGHT_PYRAMID_WORK_GROUP_SIZE = 32;
+const int HEIGHT_PYRAMID_LEVELS_PER_PASS = 5;
+
 BaseSurface::BaseSurface()
 {
 	std::random_device randomDevice{};
@@ -17,3 +23,52 @@ void BaseSurface::SetDisplacementTexture(GLenum textureUnit, const char* name)
 {
 	Renderer::SetTexture2D(textureUnit, name, displacementTex);
 }
+
+void BaseSurface::UseRenderShader(ShaderMode mode)
+{
+	Renderer::UseShader(mode);
+	Renderer::SetTexture2D(GL_TEXTURE0, "displacementTex", displacementTex);
+	Renderer::SetTexture2D(GL_TEXTURE1, "normalTex", normalTex);
+}
+
+void BaseSurface::UpdateHeightPyramid()
+{
+	// the displacement texture is recreated when its resolution changes
+	GLint displacementSize;
+	glBindTexture(GL_TEXTURE_2D, displacementTex);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &displacementSize);
+	if (displacementSize != heightPyramidSize)
+	{
+		glDeleteTextures(1, &heightPyramidTex);
+		heightPyramidSize = displacementSize;
+		heightPyramidLevelCount = 1;
+		while ((heightPyramidSize >> heightPyramidLevelCount) > 0)
+			heightPyramidLevelCount++;
+		heightPyramidTex = Renderer::CreateTextureStorage2D(heightPyramidSize, heightPyramidSize, heightPyramidLevelCount, GL_RGBA32F);
+	}
+
+	Renderer::UseShader(ShaderMode::ComputeHeightPyramid);
+	Renderer::SetTexture2D(GL_TEXTURE0, "displacementTex", displacementTex);
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+	// level 0 comes straight from the displacement, each pass then adds up to 5 levels on top of its source level
+	for (int sourceLevel = 0; sourceLevel < heightPyramidLevelCount; sourceLevel += HEIGHT_PYRAMID_LEVELS_PER_PASS)
+	{
+		int writeLevelCount = std::min(HEIGHT_PYRAMID_LEVELS_PER_PASS, heightPyramidLevelCount - 1 - sourceLevel);
+		if (sourceLevel > 0 && writeLevelCount == 0)
+			break;
+		for (int i = 0; i <= writeLevelCount; i++)
+		{
+			std::string name = "pyramidLevels[" + std::to_string(i) + "]";
+			Renderer::SetImage(i, name.c_str(), heightPyramidTex, GL_READ_WRITE, GL_RGBA32F, sourceLevel + i);
+		}
+		int sourceSize = heightPyramidSize >> sourceLevel;
+		Renderer::SetInt("sourceLevel", sourceLevel == 0 ? -1 : sourceLevel);
+		Renderer::SetInt("sourceSize", sourceSize);
+		Renderer::SetInt("writeLevelCount", writeLevelCount);
+
+		int workGroupCount = (sourceSize + HEIGHT_PYRAMID_WORK_GROUP_SIZE - 1) / HEIGHT_PYRAMID_WORK_GROUP_SIZE;
+		glDispatchCompute(workGroupCount, workGroupCount, 1);
+		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+	}
+}
\ No newline at end of file
@@ -4,17 +4,32 @@
 
 #include <glad/glad.h>
 
+#include "../Rendering/Renderer.h"
+
 class BaseSurface
 {
 protected:
 	std::mt19937 randomEngine;
 
 	GLuint normalTex = 0, displacementTex = 0;
+	GLuint heightPyramidTex = 0;
+	int heightPyramidSize = 0, heightPyramidLevelCount = 0;
 
 	BaseSurface();
 public:
 	void SetNormalTexture(GLenum textureUnit, const char* name);
 	void SetDisplacementTexture(GLenum textureUnit, const char* name);
 
+	inline GLuint GetNormalTexture() { return normalTex; }
+	inline GLuint GetDisplacementTexture() { return displacementTex; }
+	inline GLuint GetHeightPyramidTexture() { return heightPyramidTex; }
+	inline int GetHeightPyramidLevelCount() { return heightPyramidLevelCount; }
+
+	// mip chain of (min height, max height, max |dx|, max |dz|) over the displacement, the top level bounds the whole patch
+	void UpdateHeightPyramid();
+
+	// switches to a surface render shader and binds both textures to it
+	void UseRenderShader(ShaderMode mode);
+
 	virtual void PrepareRender(float simTime, bool useDisplacement) = 0;
 };
\ No newline at end of file
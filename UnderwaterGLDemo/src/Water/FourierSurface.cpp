@@ -243,9 +243,7 @@ void FourierSurface::PrepareRender(float simTime, bool useDisplacement)
 	Renderer::SetUint("fourierGridSize", gridSize);
 	glDispatchCompute(workGroupCount, workGroupCount, 1);
 
-	Renderer::UseShader(useDisplacement ? ShaderMode::SurfaceDisplacement : ShaderMode::SurfaceHeight);
-	Renderer::SetTexture2D(GL_TEXTURE0, "displacementTex", displacementTex);
-	Renderer::SetTexture2D(GL_TEXTURE1, "normalTex", normalTex);
+	UseRenderShader(useDisplacement ? ShaderMode::SurfaceDisplacement : ShaderMode::SurfaceHeight);
 }
 
 namespace
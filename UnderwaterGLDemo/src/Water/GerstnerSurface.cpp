@@ -16,9 +16,9 @@ GerstnerSurface::GerstnerSurface(float gravity)
 	// these two need to be regenerated each time using the correct size
 	unsigned int textureResolution = GetNextTextureResolution();
 	displacementTex =
-		Renderer::CreateTexture2D(textureResolution, textureResolution, GL_RGBA32F, GL_RGBA, GL_FLOAT, nullptr, GL_LINEAR);
+		Renderer::CreateTexture2D(textureResolution, textureResolution, GL_RGBA32F, GL_RGBA, GL_FLOAT, nullptr, GL_LINEAR, GL_REPEAT);
 	normalTex =
-		Renderer::CreateTexture2D(textureResolution, textureResolution, GL_RGBA32F, GL_RGBA, GL_FLOAT, nullptr, GL_LINEAR);
+		Renderer::CreateTexture2D(textureResolution, textureResolution, GL_RGBA32F, GL_RGBA, GL_FLOAT, nullptr, GL_LINEAR, GL_REPEAT);
 }
 
 void GerstnerSurface::RegenerateWaveData(float gravity)
@@ -31,9 +31,9 @@ void GerstnerSurface::RegenerateWaveData(float gravity)
 		prevTextureResolutionPower = textureResolutionPower;
 		unsigned int textureResolution = GetNextTextureResolution();
 		displacementTex =
-			Renderer::CreateTexture2D(textureResolution, textureResolution, GL_RGBA32F, GL_RGBA, GL_FLOAT, nullptr, GL_LINEAR);
+			Renderer::CreateTexture2D(textureResolution, textureResolution, GL_RGBA32F, GL_RGBA, GL_FLOAT, nullptr, GL_LINEAR, GL_REPEAT);
 		normalTex =
-			Renderer::CreateTexture2D(textureResolution, textureResolution, GL_RGBA32F, GL_RGBA, GL_FLOAT, nullptr, GL_LINEAR);
+			Renderer::CreateTexture2D(textureResolution, textureResolution, GL_RGBA32F, GL_RGBA, GL_FLOAT, nullptr, GL_LINEAR, GL_REPEAT);
 	}
 	prevWaveCount = waveCount;
 }
@@ -97,7 +97,5 @@ void GerstnerSurface::PrepareRender(float simTime, bool useDisplacement)
 	int workGroupCount = prevTextureResolution / COMPUTE_WORK_GROUP_SIZE;
 	glDispatchCompute(workGroupCount, workGroupCount, 1);
 
-	Renderer::UseShader(useDisplacement ? ShaderMode::SurfaceDisplacement : ShaderMode::SurfaceHeight);
-	Renderer::SetTexture2D(GL_TEXTURE0, "displacementTex", displacementTex);
-	Renderer::SetTexture2D(GL_TEXTURE1, "normalTex", normalTex);
+	UseRenderShader(useDisplacement ? ShaderMode::SurfaceDisplacement : ShaderMode::SurfaceHeight);
 }
\ No newline at end of file
@@ -0,0 +1,112 @@
+#include <algorithm>
+#include <cstring>
+
+#include "SurfaceReadback.h"
+
+SurfaceReadback::SurfaceReadback()
+{
+	glGenFramebuffers(1, &fbo);
+	for (auto& slot : slots)
+	{
+		glGenBuffers(1, &slot.pbo);
+	}
+}
+
+bool SurfaceReadback::Request(GLuint texture, float simTime, int level, int x, int y, int width, int height)
+{
+	Slot& slot = slots[nextSlot];
+	if (slot.fence != nullptr)
+	{
+		skippedRequests++;
+		return false;
+	}
+
+	// the caller's texture binding has to survive, surfaces keep theirs bound for rendering
+	GLint prevTexture;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &prevTexture);
+	GLint levelWidth, levelHeight;
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_WIDTH, &levelWidth);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_HEIGHT, &levelHeight);
+	glBindTexture(GL_TEXTURE_2D, prevTexture);
+
+	x = std::clamp(x, 0, levelWidth);
+	y = std::clamp(y, 0, levelHeight);
+	width = width < 0 ? levelWidth - x : std::min(width, levelWidth - x);
+	height = height < 0 ? levelHeight - y : std::min(height, levelHeight - y);
+	if (width <= 0 || height <= 0)
+		return false;
+
+	// surface textures are written with image stores
+	glMemoryBarrier(GL_FRAMEBUFFER_BARRIER_BIT | GL_PIXEL_BUFFER_BARRIER_BIT);
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+	glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, level);
+	glReadBuffer(GL_COLOR_ATTACHMENT0);
+
+	GLsizeiptr size = (GLsizeiptr)width * height * sizeof(glm::vec4);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+	if (slot.capacity < size)
+	{
+		glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+		slot.capacity = size;
+	}
+	glReadPixels(x, y, width, height, GL_RGBA, GL_FLOAT, (void*)0);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+	slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	slot.width = width;
+	slot.height = height;
+	slot.simTime = simTime;
+	slot.frame = requestedFrames++;
+
+	nextSlot = (nextSlot + 1) % RING_SIZE;
+	return true;
+}
+
+void SurfaceReadback::Update()
+{
+	// oldest request first, so the newest finished copy ends up in latestData
+	for (int i = 0; i < RING_SIZE; i++)
+	{
+		Slot& slot = slots[(nextSlot + i) % RING_SIZE];
+		if (slot.fence == nullptr)
+			continue;
+
+		GLenum status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+		if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+			break; // later requests can't be done before this one
+
+		glDeleteSync(slot.fence);
+		slot.fence = nullptr;
+
+		size_t count = (size_t)slot.width * slot.height;
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+		void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, count * sizeof(glm::vec4), GL_MAP_READ_BIT);
+		if (mapped != nullptr)
+		{
+			latestData.resize(count);
+			std::memcpy(latestData.data(), mapped, count * sizeof(glm::vec4));
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+
+			latestWidth = slot.width;
+			latestHeight = slot.height;
+			latestSimTime = slot.simTime;
+			latestFrame = slot.frame;
+			hasData = true;
+		}
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	}
+}
+
+glm::vec4 SurfaceReadback::Sample(int x, int y)
+{
+	if (!hasData)
+		return glm::vec4{ 0.0f };
+	x = std::clamp(x, 0, latestWidth - 1);
+	y = std::clamp(y, 0, latestHeight - 1);
+	return latestData[x + y * latestWidth];
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// copies a region of an RGBA32F surface texture to the CPU through a ring of PBOs,
+// results arrive a frame or two late, but the pipeline is never stalled
+class SurfaceReadback
+{
+public:
+	static const int RING_SIZE = 3;
+
+private:
+	struct Slot
+	{
+		GLuint pbo = 0;
+		GLsync fence = nullptr;
+		GLsizeiptr capacity = 0;
+		int width = 0, height = 0;
+		float simTime = 0.0f;
+		unsigned int frame = 0;
+	};
+
+	GLuint fbo;
+	std::array<Slot, RING_SIZE> slots;
+	int nextSlot = 0;
+	unsigned int requestedFrames = 0;
+	unsigned int skippedRequests = 0;
+
+	std::vector<glm::vec4> latestData;
+	int latestWidth = 0, latestHeight = 0;
+	float latestSimTime = 0.0f;
+	unsigned int latestFrame = 0;
+	bool hasData = false;
+
+public:
+	SurfaceReadback();
+
+	// returns false (and copies nothing) if every slot is still in flight
+	bool Request(GLuint texture, float simTime, int level = 0, int x = 0, int y = 0, int width = -1, int height = -1);
+	// picks up finished copies, never waits for the GPU
+	void Update();
+
+	inline bool HasData() { return hasData; }
+	inline const std::vector<glm::vec4>& GetData() { return latestData; }
+	inline int GetWidth() { return latestWidth; }
+	inline int GetHeight() { return latestHeight; }
+	inline float GetSimTime() { return latestSimTime; }
+	inline unsigned int GetFrame() { return latestFrame; }
+	inline unsigned int GetRequestedFrames() { return requestedFrames; }
+	inline unsigned int GetSkippedRequests() { return skippedRequests; }
+
+	glm::vec4 Sample(int x, int y);
+};
\ No newline at end of file
@@ -11,15 +11,32 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include "Rendering/BudgetedJob.h"
+#include "Rendering/CausticDenoiser.h"
+#include "Rendering/CausticMap.h"
+#include "Rendering/ChunkedPlane.h"
+#include "Rendering/ClipmapPlane.h"
 #include "Rendering/DynamicPointMesh.h"
+#include "Rendering/GpuTimer.h"
+#include "Rendering/Light.h"
+#include "Rendering/LinearBvh.h"
 #include "Rendering/Model.h"
+#include "Rendering/PhotonHashGrid.h"
+#include "Rendering/PhotonTracer.h"
 #include "Rendering/Plane.h"
+#include "Rendering/ProjectedGridPlane.h"
+#include "Rendering/RasterCaustics.h"
+#include "Rendering/ProceduralPlane.h"
 #include "Rendering/Scene.h"
+#include "Rendering/SceneHeightfield.h"
 #include "Rendering/Shader.h"
+#include "Rendering/TessellatedPlane.h"
+#include "Rendering/TopLevelBvh.h"
 #include "Rendering/Renderer.h"
 
 #include "Water/FourierSurface.h"
 #include "Water/GerstnerSurface.h"
+#include "Water/SurfaceReadback.h"
 
 const unsigned int WINDOW_WIDTH = 1600;
 const unsigned int WINDOW_HEIGHT = 900;
@@ -33,9 +50,46 @@ const float SCENE_HEIGHT = 30.0f;
 const float CAM_MOVE_SPEED = 10.0f;
 const float CAM_ROTATE_SPEED = 0.1f;
 const unsigned int COMPUTE_CHUNK = 32;
+const int GEOMETRY_BENCHMARK_RUNS = 20;
+const int PHOTON_BENCHMARK_RUNS = 10;
+const int MAX_SCENE_COPIES = 16;
+const float SCENE_COPY_BOB_HEIGHT = 0.5f;
+const unsigned int PHOTON_SCALING_COUNTS[]{ 16384, 65536, 262144, 1048576 };
+const int MIN_PHOTON_BUDGET = 1024;
+const int MAX_PHOTON_BUDGET = 1048576;
+const int MAX_BAKE_PHOTONS = 1 << 28;
 
 const float GRAVITY = 9.8f;
 
+enum class SurfaceGeometry
+{
+	FullGrid,
+	SharedChunk,
+	VertexId,
+	Clipmap,
+	ProjectedGrid,
+	Tessellated
+};
+const char* SURFACE_GEOMETRY_NAMES[]{ "Full grid", "Shared chunk", "Vertex ID grid", "Clipmap", "Projected grid", "Tessellation" };
+
+// matches surface_intersection_* in photonTrace.glsl
+enum class SurfaceIntersection
+{
+	Triangles,
+	HeightfieldMarch,
+	LinearBvh
+};
+const char* SURFACE_INTERSECTION_NAMES[]{ "Chunk boxes + triangles", "Heightfield march", "Linear BVH" };
+
+enum class CausticEstimate
+{
+	SplatMap,
+	PhotonDensity
+};
+const char* CAUSTIC_ESTIMATE_NAMES[]{ "Splat map", "Photon density" };
+
+const char* PHOTON_EMIT_ORDER_NAMES[]{ "R2 sequence", "Row-major grid", "Tiled grid", "Morton curve" };
+
 float lastX = WINDOW_WIDTH / 2, lastY = WINDOW_HEIGHT / 2;
 
 void ProcessKeyboard(GLFWwindow* window, float dt);
@@ -89,6 +143,11 @@ int main()
 	// scenes
 	float scenePosition[]{ 0.0f, 0.0f, 0.0f };
 	float sceneSize = 1.0f;
+	// copies share the scene's meshes and BLAS, only their transforms differ
+	int sceneCopyCount = 1;
+	float sceneCopySpacing = 8.0f;
+	bool bobSceneCopies = false;
+	std::vector<glm::mat4> sceneCopyMatrices;
 	Scene sceneCornellOriginal{ "assets/scenes/cornell/CornellBox-Sphere.obj" };
 
 	// water things
@@ -100,13 +159,73 @@ int main()
 	float surfaceSize = 20.0f;
 	Plane waterPlane = MakeXZPlane(waterMat, gridVertexCount, CHUNK_VERTEX_COUNT);
 	waterPlane.SetScale(surfaceSize);
+	bool useChunkCulling = false;
+	bool useBufferedVertices = false;
+	ChunkedPlane waterChunkPlane = MakeChunkedXZPlane(waterMat, gridVertexCount, CHUNK_VERTEX_COUNT);
+	waterChunkPlane.SetScale(surfaceSize);
+	ProceduralPlane waterGridPlane{ waterMat, (unsigned int)gridVertexCount };
+	waterGridPlane.SetScale(surfaceSize);
+	int clipmapLevelCount = 6, clipmapCellCount = 64;
+	ClipmapPlane waterClipmapPlane{ waterMat, clipmapLevelCount, clipmapCellCount, (unsigned int)gridVertexCount };
+	waterClipmapPlane.SetScale(surfaceSize);
+	int projectedGridResolution = 256;
+	float projectedGridMargin = 0.1f;
+	ProjectedGridPlane waterProjectedPlane{ waterMat, projectedGridResolution, projectedGridResolution, projectedGridMargin };
+	waterProjectedPlane.SetScale(surfaceSize);
+	int tessBaseCount = 64;
+	float tessEdgeLength = 16.0f, tessCurvatureScale = 4.0f;
+	TessellatedPlane waterTessPlane = MakeTessellatedXZPlane(waterMat, tessBaseCount);
+	waterTessPlane.SetScale(surfaceSize);
+	int surfaceGeometry = static_cast<int>(SurfaceGeometry::FullGrid);
+
+	GpuTimer surfaceTimer;
+	std::string geometryBenchmarkResult;
 
 	GerstnerSurface gerstnerSurface{ GRAVITY };
 	FourierSurface fourierSurface{ GRAVITY };
 	BaseSurface* currentSurface;
 
-	const int DEBUG_PHOTON_SIZE_1 = 10, DEBUG_PHOTON_SIZE_2 = 10;
-	DynamicPointMesh DEBUG_DPM{ DEBUG_PHOTON_SIZE_1 * DEBUG_PHOTON_SIZE_2 * 1024, 5.0f, glm::vec4{1.0f, 0.0f, 0.0f, 1.0f} };
+	SurfaceReadback displacementReadback, normalReadback;
+	bool useReadback = false;
+
+	Light light;
+	const int DEBUG_PHOTON_POINT_COUNT = 102400;
+	DynamicPointMesh DEBUG_DPM{ DEBUG_PHOTON_POINT_COUNT, 5.0f, glm::vec4{1.0f, 0.0f, 0.0f, 1.0f} };
+	bool castPhotons = false, useSceneBvh = true;
+	int surfaceIntersection = static_cast<int>(SurfaceIntersection::LinearBvh);
+	int photonEmitOrder = static_cast<int>(PhotonEmitOrder::Morton);
+	LinearBvh waterBvh;
+	TopLevelBvh photonInstances;
+	int causticResolution = 512;
+	float causticRegionSize = 20.0f, causticBlend = 0.2f;
+	bool showCaustics = true;
+	PhotonTracer photonTracer;
+	int photonDepth = 4, photonBudget = DEBUG_PHOTON_POINT_COUNT;
+	float sceneAlbedo = 0.5f;
+	unsigned int photonSeed = 0, photonSampleOffset = 0;
+	CausticMap causticMap{ causticResolution, glm::vec2{ 0.0f }, causticRegionSize };
+	PhotonHashGrid photonHashGrid;
+	int causticEstimate = static_cast<int>(CausticEstimate::SplatMap);
+	int photonDensityNearest = 16;
+	float photonDensityRadius = 0.25f;
+	GpuTimer photonTimer, photonHashTimer, waterBvhTimer;
+	bool useRasterCaustics = false;
+	int rasterCausticCellCount = 256;
+	RasterCaustics rasterCaustics{ rasterCausticCellCount };
+	GpuTimer rasterCausticTimer;
+	CausticDenoiser causticDenoiser;
+	bool denoiseCaustics = false;
+	GpuTimer causticDenoiseTimer;
+	int photonRaysPerDispatch = 0;
+	int bakePhotonCount = 1 << 24;
+	BudgetedJob photonBake{ 8.0f, MAX_PHOTON_BUDGET };
+	bool holdBakedCaustics = false; // a finished bake is kept until the light or the photon settings change
+	unsigned int lastPhotonCount = 0; // photons in the last dispatch, the ones the point mesh and the hash grid hold
+	bool useSceneHeightfield = false;
+	int sceneHeightfieldResolution = 512;
+	unsigned int sceneHeightfieldBuildCount = 0;
+	SceneHeightfield sceneHeightfield{ sceneHeightfieldResolution };
+	std::string photonBenchmarkResult;
 
 	float timeMult = 1.0f;
 	float lastTime = glfwGetTime(), simTime = 0;
@@ -130,9 +249,23 @@ int main()
 		ImGui::SliderFloat("Time multiplier", &timeMult, 0.01f, 10.0f, "%.3f", ImGuiSliderFlags_AlwaysClamp);
 		simTime += timeMult * diffT;
 
+		bool lightChanged = ImGui::SliderFloat3("Light position", &light.position.x, -20.0f, 20.0f, "%.3f", ImGuiSliderFlags_AlwaysClamp);
+		lightChanged |= ImGui::SliderFloat3("Light direction", &light.direction.x, -1.0f, 1.0f, "%.3f", ImGuiSliderFlags_AlwaysClamp);
+		lightChanged |= ImGui::SliderFloat("Light cone angle", &light.coneAngle, 1.0f, 180.0f, "%.1f", ImGuiSliderFlags_AlwaysClamp);
+		lightChanged |= ImGui::ColorEdit3("Light color", &light.color.x);
+		lightChanged |= ImGui::SliderFloat("Light power", &light.power, 0.0f, 10000.0f, "%.1f", ImGuiSliderFlags_AlwaysClamp);
+		if (glm::length(light.direction) < 0.001f)
+			light.direction = glm::vec3{ 0.0f, -1.0f, 0.0f };
+		Renderer::SetLight(light);
+
 		if (ImGui::SliderFloat("Surface size", &surfaceSize, MIN_SURFACE_SIZE, MAX_SURFACE_SIZE, "%.3f", ImGuiSliderFlags_AlwaysClamp))
 		{
 			waterPlane.SetScale(surfaceSize);
+			waterChunkPlane.SetScale(surfaceSize);
+			waterGridPlane.SetScale(surfaceSize);
+			waterClipmapPlane.SetScale(surfaceSize);
+			waterProjectedPlane.SetScale(surfaceSize);
+			waterTessPlane.SetScale(surfaceSize);
 		}
 		std::string patchCountString = std::to_string(patchCount);
 		if (ImGui::SliderInt("Patch count", &patchCountLevel, 1, 5, patchCountString.c_str(), ImGuiSliderFlags_AlwaysClamp | ImGuiSliderFlags_NoInput))
@@ -140,13 +273,87 @@ int main()
 			patchCount = 2 * patchCountLevel - 1;
 		}
 		ImGui::SliderInt("Grid count", &gridVertexCount, MIN_GRID_COUNT, MAX_GRID_COUNT, "%d", ImGuiSliderFlags_AlwaysClamp);
+		ImGui::Combo("Surface geometry", &surfaceGeometry, SURFACE_GEOMETRY_NAMES, IM_ARRAYSIZE(SURFACE_GEOMETRY_NAMES));
+		if (surfaceGeometry == static_cast<int>(SurfaceGeometry::FullGrid))
+		{
+			ImGui::Checkbox("GPU chunk culling", &useChunkCulling);
+			if (useChunkCulling)
+			{
+				Plane::CullingStats cullingStats = waterPlane.GetCullingStats();
+				ImGui::Text("Visible chunks: %u / %u", cullingStats.visibleChunks, waterPlane.GetChunkCount() * patchCount * patchCount);
+			}
+			ImGui::Checkbox("Precomputed vertices", &useBufferedVertices);
+		}
+		if (surfaceGeometry == static_cast<int>(SurfaceGeometry::Clipmap))
+		{
+			bool clipmapChanged = ImGui::SliderInt("Clipmap levels", &clipmapLevelCount,
+												   ClipmapPlane::MIN_LEVEL_COUNT, ClipmapPlane::MAX_LEVEL_COUNT, "%d", ImGuiSliderFlags_AlwaysClamp);
+			clipmapChanged |= ImGui::SliderInt("Clipmap ring cells", &clipmapCellCount,
+											   ClipmapPlane::MIN_CELL_COUNT, ClipmapPlane::MAX_CELL_COUNT, "%d", ImGuiSliderFlags_AlwaysClamp);
+			if (clipmapChanged)
+			{
+				waterClipmapPlane.Recreate(clipmapLevelCount, clipmapCellCount, gridVertexCount);
+			}
+			ImGui::Text("Clipmap: %u triangles, %.1f wide", waterClipmapPlane.GetTriangleCount(), waterClipmapPlane.GetExtent());
+		}
+		if (surfaceGeometry == static_cast<int>(SurfaceGeometry::ProjectedGrid))
+		{
+			if (ImGui::SliderInt("Projected grid resolution", &projectedGridResolution,
+								 ProjectedGridPlane::MIN_RESOLUTION, ProjectedGridPlane::MAX_RESOLUTION, "%d", ImGuiSliderFlags_AlwaysClamp))
+			{
+				waterProjectedPlane.Recreate(projectedGridResolution, projectedGridResolution);
+			}
+			if (ImGui::SliderFloat("Projected grid margin", &projectedGridMargin, 0.0f, 1.0f, "%.3f", ImGuiSliderFlags_AlwaysClamp))
+			{
+				waterProjectedPlane.SetMargin(projectedGridMargin);
+			}
+		}
+		if (surfaceGeometry == static_cast<int>(SurfaceGeometry::Tessellated))
+		{
+			ImGui::SliderInt("Tessellation base quads", &tessBaseCount,
+							 TessellatedPlane::MIN_BASE_COUNT, TessellatedPlane::MAX_BASE_COUNT, "%d", ImGuiSliderFlags_AlwaysClamp);
+			if (ImGui::SliderFloat("Tessellation edge pixels", &tessEdgeLength, 2.0f, 64.0f, "%.1f", ImGuiSliderFlags_AlwaysClamp))
+			{
+				waterTessPlane.SetEdgeLength(tessEdgeLength);
+			}
+			if (ImGui::SliderFloat("Tessellation curvature", &tessCurvatureScale, 0.0f, 32.0f, "%.2f", ImGuiSliderFlags_AlwaysClamp))
+			{
+				waterTessPlane.SetCurvatureScale(tessCurvatureScale);
+			}
+		}
 		if (ImGui::Button("Regenerate surface"))
 		{
-			waterPlane.Recreate(gridVertexCount, CHUNK_VERTEX_COUNT);
+			switch (static_cast<SurfaceGeometry>(surfaceGeometry))
+			{
+			case SurfaceGeometry::FullGrid:
+				waterPlane.Recreate(gridVertexCount, CHUNK_VERTEX_COUNT);
+				waterBvh.Invalidate();
+				break;
+			case SurfaceGeometry::SharedChunk:
+				waterChunkPlane.Recreate(gridVertexCount, CHUNK_VERTEX_COUNT);
+				break;
+			case SurfaceGeometry::VertexId:
+				waterGridPlane.Recreate(gridVertexCount);
+				break;
+			case SurfaceGeometry::Clipmap:
+				waterClipmapPlane.Recreate(clipmapLevelCount, clipmapCellCount, gridVertexCount);
+				break;
+			case SurfaceGeometry::ProjectedGrid:
+				waterProjectedPlane.Recreate(projectedGridResolution, projectedGridResolution);
+				break;
+			case SurfaceGeometry::Tessellated:
+				waterTessPlane.Recreate(tessBaseCount);
+				break;
+			}
 		}
 		if (ImGui::ColorEdit3("Surface color", waterColor))
 		{
 			waterPlane.SetColor(waterColor);
+			waterChunkPlane.SetColor(waterColor);
+			waterGridPlane.SetColor(waterColor);
+			waterClipmapPlane.SetColor(waterColor);
+			waterProjectedPlane.SetColor(waterColor);
+			waterTessPlane.SetColor(waterColor);
 		}
 		ImGui::Checkbox("Displacement", &useDisplacement);
 
@@ -220,8 +427,179 @@ int main()
 
 		currentSurface->PrepareRender(simTime, useDisplacement);
 
-		Renderer::SetInt("patchCount", patchCount);
-		waterPlane.RenderInstanced(patchCount * patchCount);
+		ImGui::Checkbox("CPU readback", &useReadback);
+		if (useReadback)
+		{
+			displacementReadback.Update();
+			normalReadback.Update();
+			displacementReadback.Request(currentSurface->GetDisplacementTexture(), simTime);
+			normalReadback.Request(currentSurface->GetNormalTexture(), simTime);
+			if (displacementReadback.HasData())
+			{
+				glm::vec4 centerDisplacement = displacementReadback.Sample(displacementReadback.GetWidth() / 2, displacementReadback.GetHeight() / 2);
+				ImGui::Text("Readback frame %u (%u behind), t = %.3f", displacementReadback.GetFrame(),
+							displacementReadback.GetRequestedFrames() - 1 - displacementReadback.GetFrame(), displacementReadback.GetSimTime());
+				ImGui::Text("Center displacement: %.4f, %.4f, %.4f", centerDisplacement.x, centerDisplacement.y, centerDisplacement.z);
+				ImGui::Text("Skipped requests: %u", displacementReadback.GetSkippedRequests());
+			}
+		}
+
+		unsigned int geometryVertexCount = 0, geometryIndexCount = 0, geometryTriangleCount = 0;
+		size_t geometryBytes = 0;
+		auto renderWater = [&](SurfaceGeometry geometry)
+		{
+			int patchInstanceCount = patchCount * patchCount;
+			switch (geometry)
+			{
+			case SurfaceGeometry::FullGrid:
+				geometryVertexCount = waterPlane.GetVertexCount();
+				geometryIndexCount = waterPlane.GetIndexCount();
+				if (useBufferedVertices)
+				{
+					// displaced once here, every patch and draw then just reads the buffer
+					waterPlane.UpdateDisplacedVertices(currentSurface->GetDisplacementTexture(), useDisplacement);
+				}
+				if (useChunkCulling)
+				{
+					currentSurface->UpdateHeightPyramid();
+					waterPlane.UpdateBoundingBoxes(currentSurface->GetHeightPyramidTexture(), currentSurface->GetHeightPyramidLevelCount());
+					waterPlane.Cull(patchCount);
+					if (useBufferedVertices)
+					{
+						currentSurface->UseRenderShader(ShaderMode::SurfaceCulledBuffered);
+						waterPlane.BindDisplacedVertexSSBO(0);
+					}
+					else
+					{
+						currentSurface->UseRenderShader(useDisplacement ? ShaderMode::SurfaceCulledDisplacement : ShaderMode::SurfaceCulledHeight);
+					}
+					Renderer::SetInt("patchCount", patchCount);
+					waterPlane.RenderCulled();
+
+					// stats lag a few frames behind
+					geometryTriangleCount = waterPlane.GetCullingStats().visibleIndices / 3;
+				}
+				else
+				{
+					if (useBufferedVertices)
+					{
+						currentSurface->UseRenderShader(ShaderMode::SurfaceBuffered);
+						waterPlane.BindDisplacedVertexSSBO(0);
+					}
+					else
+					{
+						currentSurface->UseRenderShader(useDisplacement ? ShaderMode::SurfaceDisplacement : ShaderMode::SurfaceHeight);
+					}
+					Renderer::SetInt("patchCount", patchCount);
+					waterPlane.RenderInstanced(patchInstanceCount);
+
+					geometryTriangleCount = geometryIndexCount / 3 * patchInstanceCount;
+				}
+				geometryBytes = geometryVertexCount * sizeof(PositionTexSurfaceVertex) + geometryIndexCount * sizeof(PlaneIndex);
+				if (useBufferedVertices)
+					geometryBytes += geometryVertexCount * sizeof(glm::vec4);
+				break;
+			case SurfaceGeometry::SharedChunk:
+				currentSurface->UseRenderShader(useDisplacement ? ShaderMode::SurfaceChunkDisplacement : ShaderMode::SurfaceChunkHeight);
+				Renderer::SetInt("patchCount", patchCount);
+				waterChunkPlane.RenderInstanced(patchInstanceCount);
+
+				geometryVertexCount = waterChunkPlane.GetVertexCount();
+				geometryIndexCount = waterChunkPlane.GetIndexCount();
+				geometryTriangleCount = geometryIndexCount / 3 * waterChunkPlane.GetChunkCount() * patchInstanceCount;
+				geometryBytes = geometryVertexCount * sizeof(PositionTexSurfaceVertex) + geometryIndexCount * sizeof(unsigned int) +
+					waterChunkPlane.GetChunkCount() * sizeof(glm::vec4);
+				break;
+			case SurfaceGeometry::VertexId:
+				currentSurface->UseRenderShader(useDisplacement ? ShaderMode::SurfaceGridDisplacement : ShaderMode::SurfaceGridHeight);
+				Renderer::SetInt("patchCount", patchCount);
+				waterGridPlane.RenderInstanced(patchInstanceCount);
+
+				geometryVertexCount = waterGridPlane.GetVertexCount();
+				geometryIndexCount = 0;
+				geometryTriangleCount = waterGridPlane.GetTriangleCount(patchInstanceCount);
+				geometryBytes = 0;
+				break;
+			case SurfaceGeometry::Clipmap:
+				// follows the camera instead of tiling patches
+				currentSurface->UseRenderShader(useDisplacement ? ShaderMode::SurfaceClipmapDisplacement : ShaderMode::SurfaceClipmapHeight);
+				waterClipmapPlane.Render(Renderer::GetCameraPosition());
+
+				geometryVertexCount = 3 * waterClipmapPlane.GetTriangleCount();
+				geometryIndexCount = 0;
+				geometryTriangleCount = waterClipmapPlane.GetTriangleCount();
+				geometryBytes = 0;
+				break;
+			case SurfaceGeometry::ProjectedGrid:
+				currentSurface->UseRenderShader(useDisplacement ? ShaderMode::SurfaceProjectedDisplacement : ShaderMode::SurfaceProjectedHeight);
+				waterProjectedPlane.Render(Renderer::GetCameraPosition(), Renderer::GetFarPlane());
+
+				geometryVertexCount = waterProjectedPlane.GetVertexCount();
+				geometryIndexCount = 0;
+				geometryTriangleCount = waterProjectedPlane.GetTriangleCount();
+				geometryBytes = 0;
+				break;
+			case SurfaceGeometry::Tessellated:
+				currentSurface->UseRenderShader(useDisplacement ? ShaderMode::SurfaceTessellatedDisplacement : ShaderMode::SurfaceTessellatedHeight);
+				Renderer::SetInt("patchCount", patchCount);
+				waterTessPlane.RenderInstanced(patchInstanceCount);
+
+				geometryVertexCount = waterTessPlane.GetVertexCount();
+				geometryIndexCount = waterTessPlane.GetIndexCount();
+				// tessellator output, counted on the GPU a draw or more behind
+				geometryTriangleCount = waterTessPlane.GetGeneratedTriangleCount();
+				geometryBytes = geometryVertexCount * sizeof(PositionTexSurfaceVertex) + geometryIndexCount * sizeof(unsigned int);
+				break;
+			}
+		};
+
+		if (ImGui::Button("Benchmark surface geometry"))
+		{
+			// blocking on purpose, every mode is drawn a few times into this frame
+			geometryBenchmarkResult.clear();
+			for (int geometry = 0; geometry < IM_ARRAYSIZE(SURFACE_GEOMETRY_NAMES); geometry++)
+			{
+				float totalMs = 0.0f;
+				for (int run = 0; run < GEOMETRY_BENCHMARK_RUNS; run++)
+				{
+					surfaceTimer.Begin(true);
+					renderWater(static_cast<SurfaceGeometry>(geometry));
+					surfaceTimer.End();
+					totalMs += surfaceTimer.Wait();
+				}
+				float averageMs = totalMs / GEOMETRY_BENCHMARK_RUNS;
+				char line[256];
+				snprintf(line, sizeof(line), "%s: %.3f ms, %.1f Mtris/s, %.2f MB\n", SURFACE_GEOMETRY_NAMES[geometry], averageMs,
+						 geometryTriangleCount / (averageMs * 1000.0f), geometryBytes / (1024.0f * 1024.0f));
+				geometryBenchmarkResult += line;
+			}
+			std::cout << geometryBenchmarkResult;
+		}
+
+		surfaceTimer.Begin();
+		renderWater(static_cast<SurfaceGeometry>(surfaceGeometry));
+		surfaceTimer.End();
+		surfaceTimer.Update();
+		ImGui::Text("Surface geometry: %u vertices, %u indices, %.2f MB", geometryVertexCount, geometryIndexCount, geometryBytes / (1024.0f * 1024.0f));
+		ImGui::Text("Surface draw: %.3f ms, %.1f Mtris/s", surfaceTimer.GetAverageMilliseconds(),
+					geometryTriangleCount / (std::max(surfaceTimer.GetAverageMilliseconds(), 0.001f) * 1000.0f));
+		if (!geometryBenchmarkResult.empty())
+			ImGui::Text("%s", geometryBenchmarkResult.c_str());
+		if (ImGui::TreeNode("Vertex cache (ACMR / ATVR)"))
+		{
+			auto showCacheReport = [](const char* name, const MeshOptimizer::CacheReport& report)
+			{
+				ImGui::Text("%s: %.3f / %.3f -> %.3f / %.3f", name, report.before.GetACMR(), report.before.GetATVR(),
+							report.after.GetACMR(), report.after.GetATVR());
+			};
+			showCacheReport("Water plane", waterPlane.GetCacheReport());
+			for (size_t i = 0; i < sceneCornellOriginal.cacheReports.size(); i++)
+			{
+				std::string modelName = "Scene model " + std::to_string(i);
+				showCacheReport(modelName.c_str(), sceneCornellOriginal.cacheReports[i]);
+			}
+			ImGui::TreePop();
+		}
 
 		if (ImGui::SliderFloat("Scene size", &sceneSize, 0.1f, 20.0f, "%.3f", ImGuiSliderFlags_AlwaysClamp))
 		{
@@ -232,35 +610,408 @@ int main()
 			sceneCornellOriginal.SetPosition(scenePosition);
 		}
 
-		Renderer::UseShader(ShaderMode::Phong);
-		sceneCornellOriginal.Render();
-
-		// TODO: test
-		//Renderer::UseShader(ShaderMode::ComputeSurfaceBoundingBoxes);
-		//waterPlane.BindVertexSSBO(0);
-		//waterPlane.BindChunkInfoSSBO(1);
-		//currentSurface->SetDisplacementTexture(GL_TEXTURE0, "displacementTex");
-		//
-		//glDispatchCompute((CHUNK_VERTEX_COUNT * CHUNK_VERTEX_COUNT) / 1024, 1, 1); // TODO: calculate based on surface chunk count
-		//glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
-
-		//Renderer::UseShader(ShaderMode::ComputePhotonMappingCastRays);
-		//sceneCornellOriginal.EnableSceneModelMatrix();
-		//sceneCornellOriginal.BindSSBOs(0, 1, 2);
-
-		//waterPlane.EnableModelMatrix("surfaceM");
-		//currentSurface->SetDisplacementTexture(GL_TEXTURE0, "surfaceDisplacementTex");
-		//currentSurface->SetDisplacementTexture(GL_TEXTURE1, "surfaceNormalTex");
-		//Renderer::SetInt("surfacePatchCount", patchCount);
-		//waterPlane.BindSSBOs(3, 4, 5);
-
-		//DEBUG_DPM.BindVertexSSBO(6);
-		//glDispatchCompute(DEBUG_PHOTON_SIZE_1, DEBUG_PHOTON_SIZE_2, 1);
-		//glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
-
-		//Renderer::UseShader(ShaderMode::Point);
-		//DEBUG_DPM.Render();
-		// TODO: end test
+		ImGui::SliderInt("Scene copies", &sceneCopyCount, 1, MAX_SCENE_COPIES, "%d", ImGuiSliderFlags_AlwaysClamp);
+		ImGui::SliderFloat("Scene copy spacing", &sceneCopySpacing, 0.0f, 40.0f, "%.3f", ImGuiSliderFlags_AlwaysClamp);
+		ImGui::Checkbox("Bob scene copies", &bobSceneCopies);
+
+		// copies fill a square grid next to the original, bobbing moves them without touching any BLAS
+		int sceneCopyRowLength = (int)ceilf(sqrtf((float)sceneCopyCount));
+		sceneCopyMatrices.clear();
+		for (int i = 0; i < sceneCopyCount; i++)
+		{
+			glm::vec3 copyOffset{ (i % sceneCopyRowLength) * sceneCopySpacing, 0.0f, (i / sceneCopyRowLength) * sceneCopySpacing };
+			if (bobSceneCopies)
+				copyOffset.y = SCENE_COPY_BOB_HEIGHT * sinf(simTime + i);
+			sceneCopyMatrices.push_back(glm::translate(glm::mat4{ 1.0f }, copyOffset) * sceneCornellOriginal.GetModelMatrix());
+		}
+
+		// both caustic modes write the same map, so only one of them can be on
+		if (ImGui::Checkbox("Raster caustics", &useRasterCaustics) && useRasterCaustics)
+			castPhotons = false;
+		if (ImGui::Checkbox("Cast photons", &castPhotons) && castPhotons)
+			useRasterCaustics = false;
+		if (useRasterCaustics || castPhotons)
+		{
+			ImGui::SliderFloat("Caustic region size", &causticRegionSize, 1.0f, 100.0f, "%.3f", ImGuiSliderFlags_AlwaysClamp);
+			if (ImGui::SliderInt("Caustic resolution", &causticResolution, CausticMap::MIN_RESOLUTION, CausticMap::MAX_RESOLUTION, "%d",
+								 ImGuiSliderFlags_AlwaysClamp))
+			{
+				causticMap.Recreate(causticResolution);
+			}
+			causticMap.SetRegion(glm::vec2{ scenePosition[0], scenePosition[2] }, causticRegionSize);
+			// the scene checks caustic texels against these receiver heights, cached photons march through them too
+			// only moving receivers or a new region cost a render, the water moving every frame doesn't
+			if (sceneHeightfield.NeedsUpdate(causticMap, sceneCopyMatrices, sceneCornellOriginal.boundsMin, sceneCornellOriginal.boundsMax))
+			{
+				sceneHeightfield.Begin(causticMap);
+				for (glm::mat4& copyMatrix : sceneCopyMatrices)
+					sceneCornellOriginal.Render(copyMatrix);
+				sceneHeightfield.End();
+				sceneHeightfieldBuildCount++;
+			}
+		}
+
+		if (useRasterCaustics)
+		{
+			if (ImGui::SliderInt("Raster caustic grid", &rasterCausticCellCount, RasterCaustics::MIN_CELL_COUNT, RasterCaustics::MAX_CELL_COUNT,
+								 "%d", ImGuiSliderFlags_AlwaysClamp))
+			{
+				rasterCaustics.Recreate(rasterCausticCellCount);
+			}
+
+			// the receiver is the floor of the scene, light that misses it lands on the same plane anyway
+			glm::vec4 sceneFloor = sceneCornellOriginal.GetModelMatrix() * glm::vec4(sceneCornellOriginal.boundsMin, 1.0f);
+			float coneSolidAngle = 2.0f * glm::pi<float>() * (1.0f - cosf(glm::radians(light.coneAngle)));
+			rasterCausticTimer.Begin();
+			rasterCaustics.Render(causticMap, currentSurface->GetDisplacementTexture(), currentSurface->GetNormalTexture(),
+								  waterPlane.GetModelMatrix(), patchCount, useDisplacement, sceneFloor.y, light.power / coneSolidAngle);
+			rasterCausticTimer.End();
+			rasterCausticTimer.Update();
+			ImGui::Text("Raster caustics: %u triangles, %.3f ms", rasterCaustics.GetTriangleCount(patchCount),
+						rasterCausticTimer.GetAverageMilliseconds());
+		}
+
+		// photon caustics are from the previous frame's photons, they are cast after the scene is drawn
+		bool usePhotonDensity = castPhotons && showCaustics && causticEstimate == static_cast<int>(CausticEstimate::PhotonDensity)
+			&& photonHashGrid.GetCapacity() > 0;
+		if (usePhotonDensity)
+		{
+			Renderer::UseShader(ShaderMode::PhongPhotonDensity);
+			photonHashGrid.BindQuery();
+			Renderer::SetUint("photonDensityNearest", photonDensityNearest);
+			Renderer::SetFloat("photonDensityRadius", photonDensityRadius);
+			Renderer::SetFloat("photonFlux", light.power / lastPhotonCount);
+		}
+		else
+		{
+			Renderer::UseShader(ShaderMode::Phong);
+			Renderer::SetInt("useCaustics", (castPhotons && showCaustics) || useRasterCaustics);
+			if (castPhotons && denoiseCaustics)
+				causticDenoiser.SetIrradianceTexture(GL_TEXTURE0, "causticTex", causticMap);
+			else
+				causticMap.SetIrradianceTexture(GL_TEXTURE0, "causticTex");
+			sceneHeightfield.SetHeightfieldTexture(GL_TEXTURE1, "causticReceiverTex");
+		}
+		for (glm::mat4& copyMatrix : sceneCopyMatrices)
+			sceneCornellOriginal.Render(copyMatrix);
+
+		if (castPhotons)
+		{
+			ImGui::Checkbox("Scene BVH", &useSceneBvh);
+			bool photonsChanged = ImGui::Combo("Water intersection", &surfaceIntersection, SURFACE_INTERSECTION_NAMES,
+											   IM_ARRAYSIZE(SURFACE_INTERSECTION_NAMES));
+			// photons under the water find their first receiver in a cached heightfield instead of the scene
+			photonsChanged |= ImGui::Checkbox("Cached receivers", &useSceneHeightfield);
+			if (useSceneHeightfield && ImGui::SliderInt("Receiver resolution", &sceneHeightfieldResolution, SceneHeightfield::MIN_RESOLUTION,
+														SceneHeightfield::MAX_RESOLUTION, "%d", ImGuiSliderFlags_AlwaysClamp))
+			{
+				sceneHeightfield.Recreate(sceneHeightfieldResolution);
+			}
+			ImGui::Checkbox("Show caustics", &showCaustics);
+			ImGui::Combo("Caustic estimate", &causticEstimate, CAUSTIC_ESTIMATE_NAMES, IM_ARRAYSIZE(CAUSTIC_ESTIMATE_NAMES));
+			if (causticEstimate == static_cast<int>(CausticEstimate::PhotonDensity))
+			{
+				// the hash cells are twice the radius, so a query never spans more than two cells per axis
+				ImGui::SliderFloat("Density radius", &photonDensityRadius, 0.01f, 2.0f, "%.3f", ImGuiSliderFlags_AlwaysClamp);
+				ImGui::SliderInt("Density nearest photons", &photonDensityNearest, 0, 32, "%d", ImGuiSliderFlags_AlwaysClamp);
+			}
+			photonsChanged |= ImGui::SliderInt("Photon budget", &photonBudget, MIN_PHOTON_BUDGET, MAX_PHOTON_BUDGET, "%d",
+											   ImGuiSliderFlags_AlwaysClamp | ImGuiSliderFlags_Logarithmic);
+			photonsChanged |= ImGui::Combo("Photon emission order", &photonEmitOrder, PHOTON_EMIT_ORDER_NAMES,
+										   IM_ARRAYSIZE(PHOTON_EMIT_ORDER_NAMES));
+			// 0 keeps one indirect dispatch per stage
+			if (ImGui::SliderInt("Rays per dispatch", &photonRaysPerDispatch, 0, MAX_PHOTON_BUDGET, "%d",
+								 ImGuiSliderFlags_AlwaysClamp | ImGuiSliderFlags_Logarithmic))
+			{
+				photonTracer.SetMaxRaysPerDispatch(photonRaysPerDispatch);
+			}
+			photonsChanged |= ImGui::SliderInt("Photon bounces", &photonDepth, 1, PhotonTracer::MAX_DEPTH, "%d", ImGuiSliderFlags_AlwaysClamp);
+			photonsChanged |= ImGui::SliderFloat("Scene albedo", &sceneAlbedo, 0.0f, 1.0f, "%.3f", ImGuiSliderFlags_AlwaysClamp);
+			// 1 shows only the current frame, lower keeps more history but smears the caustics of moving water
+			ImGui::SliderFloat("Caustic blend", &causticBlend, 0.01f, 1.0f, "%.3f", ImGuiSliderFlags_AlwaysClamp);
+			// the denoiser keeps its own history, the map then only holds the current frame
+			if (ImGui::Checkbox("Denoise caustics", &denoiseCaustics))
+				causticDenoiser.ResetHistory();
+			if (denoiseCaustics)
+			{
+				ImGui::SliderInt("Denoise downsample", &causticDenoiser.downsample, 1, CausticDenoiser::MAX_DOWNSAMPLE, "%d",
+								 ImGuiSliderFlags_AlwaysClamp);
+				ImGui::SliderInt("Denoise iterations", &causticDenoiser.iterationCount, 1, CausticDenoiser::MAX_ITERATIONS, "%d",
+								 ImGuiSliderFlags_AlwaysClamp);
+				ImGui::SliderFloat("Denoise blend", &causticDenoiser.blend, 0.01f, 1.0f, "%.3f", ImGuiSliderFlags_AlwaysClamp);
+				ImGui::SliderFloat("Denoise normal phi", &causticDenoiser.normalPhi, 1.0f, 128.0f, "%.1f", ImGuiSliderFlags_AlwaysClamp);
+				ImGui::SliderFloat("Denoise height phi", &causticDenoiser.heightPhi, 0.01f, 10.0f, "%.3f", ImGuiSliderFlags_AlwaysClamp);
+			}
+			ImGui::SliderInt("Bake photons", &bakePhotonCount, MAX_PHOTON_BUDGET, MAX_BAKE_PHOTONS, "%d",
+							 ImGuiSliderFlags_AlwaysClamp | ImGuiSliderFlags_Logarithmic);
+			ImGui::SliderFloat("Bake budget (ms)", &photonBake.budgetMilliseconds, 1.0f, 100.0f, "%.1f", ImGuiSliderFlags_AlwaysClamp);
+			if (!photonBake.IsActive() && ImGui::Button("Bake caustics"))
+			{
+				// chunks replace the per-frame budget until the bake is done
+				photonBake.Start(bakePhotonCount);
+				photonsChanged = true;
+			}
+			if (photonBake.IsActive())
+			{
+				char progress[64];
+				snprintf(progress, sizeof(progress), "%u / %u photons", photonBake.GetDoneWork(), photonBake.GetTotalWork());
+				ImGui::ProgressBar(photonBake.GetProgress(), ImVec2{ -1.0f, 0.0f }, progress);
+				ImGui::Text("Bake chunk: %u photons, %.3f ms", photonBake.GetChunkSize(), photonBake.GetLastMilliseconds());
+				if (ImGui::Button("Cancel bake"))
+				{
+					photonBake.Cancel();
+					// what was baked so far is still a complete average
+					holdBakedCaustics = photonBake.GetDoneWork() > 0;
+				}
+			}
+			if (lightChanged || photonsChanged)
+			{
+				causticMap.ResetAccumulation();
+				causticDenoiser.ResetHistory();
+			}
+
+			currentSurface->UpdateHeightPyramid();
+			waterPlane.UpdateBoundingBoxes(currentSurface->GetHeightPyramidTexture(), currentSurface->GetHeightPyramidLevelCount());
+			waterPlane.UpdateDisplacedVertices(currentSurface->GetDisplacementTexture(), useDisplacement);
+			if (!waterBvh.IsBuilt())
+				waterBvh.Build(waterPlane);
+			waterBvhTimer.Begin();
+			waterBvh.Refit(waterPlane);
+			waterBvhTimer.End();
+			waterBvhTimer.Update();
+
+			// one instance per scene copy and per water patch, the patch shift moves the ray instead of the vertices
+			photonInstances.Clear();
+			for (glm::mat4& copyMatrix : sceneCopyMatrices)
+				photonInstances.AddInstance(TopLevelBvh::BLAS_SCENE, copyMatrix, sceneCornellOriginal.boundsMin, sceneCornellOriginal.boundsMax);
+			glm::mat4 surfaceM = waterPlane.GetModelMatrix();
+			float halfGridSize = 0.5f * waterPlane.GetGridSize();
+			glm::vec3 patchMin = glm::vec3(surfaceM * glm::vec4(-halfGridSize, 0.0f, -halfGridSize, 1.0f));
+			glm::vec3 patchMax = glm::vec3(surfaceM * glm::vec4(halfGridSize, 0.0f, halfGridSize, 1.0f));
+			int patchCountHalfFloor = (patchCount - 1) / 2;
+			for (int patchZ = 0; patchZ < patchCount; patchZ++)
+			{
+				for (int patchX = 0; patchX < patchCount; patchX++)
+				{
+					glm::vec4 patchShift{ patchX - patchCountHalfFloor, 0.0f, patchZ - patchCountHalfFloor, 0.0f };
+					glm::mat4 patchMatrix = glm::translate(glm::mat4{ 1.0f }, glm::vec3(surfaceM * patchShift));
+					photonInstances.AddInstance(TopLevelBvh::BLAS_WATER, patchMatrix, patchMin, patchMax);
+				}
+			}
+			photonInstances.Build();
+			photonInstances.Refit(sceneCornellOriginal, waterBvh);
+
+			auto dispatchPhotons = [&](SurfaceIntersection intersection, unsigned int photonCount)
+			{
+				// buffer and image bindings are global, uniforms have to be set again for every stage
+				sceneCornellOriginal.BindSSBOs(1, 2);
+				waterPlane.BindDisplacedVertexSSBO(3);
+				waterPlane.BindIndexSSBO(4);
+				waterPlane.BindChunkInfoSSBO(5);
+				// photons past the point mesh's capacity are only splatted
+				DEBUG_DPM.BindVertexSSBO(6);
+				sceneCornellOriginal.BindBvhSSBOs(7, 8);
+				waterBvh.BindNodeSSBO(9);
+				photonInstances.BindSSBOs(10, 11);
+				photonHashGrid.Reset(photonCount);
+				photonHashGrid.BindPhotonSSBO(16);
+
+				photonTracer.Trace(photonCount, photonSampleOffset, static_cast<PhotonEmitOrder>(photonEmitOrder), photonDepth, [&]()
+				{
+					Renderer::SetInt("useSceneBvh", useSceneBvh);
+					Renderer::SetInt("useSceneHeightfield", useSceneHeightfield);
+					sceneHeightfield.SetHeightfieldTexture(GL_TEXTURE3, "sceneHeightfieldTex");
+					waterPlane.EnableModelMatrix("surfaceM");
+					currentSurface->SetDisplacementTexture(GL_TEXTURE0, "surfaceDisplacementTex");
+					currentSurface->SetNormalTexture(GL_TEXTURE1, "surfaceNormalTex");
+					Renderer::SetInt("surfacePatchCount", patchCount);
+					Renderer::SetInt("surfaceIntersection", static_cast<int>(intersection));
+					Renderer::SetTexture2D(GL_TEXTURE2, "surfaceHeightPyramidTex", currentSurface->GetHeightPyramidTexture());
+					Renderer::SetInt("surfaceHeightPyramidLevelCount", currentSurface->GetHeightPyramidLevelCount());
+					Renderer::SetUint("surfaceBvhLeafOffset", waterBvh.GetLeafOffset());
+					causticMap.BindAccumulation(0, "causticAccumulationImage");
+					Renderer::SetFloat("sceneAlbedo", sceneAlbedo);
+					Renderer::SetUint("photonSeed", photonSeed);
+				});
+				// a bake averages all of its chunks
+				float resolveBlend = photonBake.IsActive() ? 0.0f : denoiseCaustics ? 1.0f : causticBlend;
+				causticMap.Resolve(light.power / photonCount, photonCount, resolveBlend);
+				lastPhotonCount = photonCount;
+				// the next pass continues the emission sequence, so frames add up to one stratified set
+				photonSampleOffset += photonCount;
+			};
+			unsigned int photonRayCount = photonBudget;
+			photonSeed++;
+
+			if (ImGui::Button("Benchmark water intersection"))
+			{
+				// blocking like the geometry benchmark, the refit is listed with the BVH since only it needs one
+				photonBenchmarkResult.clear();
+				for (int intersection = 0; intersection < IM_ARRAYSIZE(SURFACE_INTERSECTION_NAMES); intersection++)
+				{
+					float totalMs = 0.0f;
+					for (int run = 0; run < PHOTON_BENCHMARK_RUNS; run++)
+					{
+						photonTimer.Begin(true);
+						dispatchPhotons(static_cast<SurfaceIntersection>(intersection), photonRayCount);
+						photonTimer.End();
+						totalMs += photonTimer.Wait();
+					}
+					float averageMs = totalMs / PHOTON_BENCHMARK_RUNS;
+					char line[256];
+					snprintf(line, sizeof(line), "%s: %.3f ms, %.1f Mphotons/s\n", SURFACE_INTERSECTION_NAMES[intersection], averageMs,
+							 photonRayCount / (averageMs * 1000.0f));
+					photonBenchmarkResult += line;
+				}
+				char line[256];
+				snprintf(line, sizeof(line), "Linear BVH build %.3f ms, refit %.3f ms\n", waterBvh.GetBuildMilliseconds(),
+						 waterBvhTimer.GetAverageMilliseconds());
+				photonBenchmarkResult += line;
+				std::cout << photonBenchmarkResult;
+				causticMap.ResetAccumulation();
+			}
+			ImGui::SameLine();
+			if (ImGui::Button("Benchmark photon count"))
+			{
+				// photon pass plus the caustic resolve, with the current water intersection
+				photonBenchmarkResult.clear();
+				for (unsigned int photonCount : PHOTON_SCALING_COUNTS)
+				{
+					float totalMs = 0.0f, totalHashMs = 0.0f;
+					for (int run = 0; run < PHOTON_BENCHMARK_RUNS; run++)
+					{
+						photonTimer.Begin(true);
+						dispatchPhotons(static_cast<SurfaceIntersection>(surfaceIntersection), photonCount);
+						photonTimer.End();
+						totalMs += photonTimer.Wait();
+						photonHashTimer.Begin(true);
+						photonHashGrid.Build(2.0f * photonDensityRadius);
+						photonHashTimer.End();
+						totalHashMs += photonHashTimer.Wait();
+					}
+					float averageMs = totalMs / PHOTON_BENCHMARK_RUNS;
+					char line[256];
+					snprintf(line, sizeof(line), "%u photons: %.3f ms, %.1f Mphotons/s, hash grid %.3f ms\n", photonCount, averageMs,
+							 photonCount / (averageMs * 1000.0f), totalHashMs / PHOTON_BENCHMARK_RUNS);
+					photonBenchmarkResult += line;
+				}
+				std::cout << photonBenchmarkResult;
+				causticMap.ResetAccumulation();
+			}
+			if (ImGui::Button("Benchmark emission order"))
+			{
+				// accelerated paths against brute force, coherent rays should help the traversals most
+				photonBenchmarkResult.clear();
+				bool prevUseSceneBvh = useSceneBvh;
+				int prevEmitOrder = photonEmitOrder;
+				for (int path = 0; path < 2; path++)
+				{
+					bool accelerated = path == 0;
+					useSceneBvh = accelerated;
+					SurfaceIntersection intersection = accelerated ? SurfaceIntersection::LinearBvh : SurfaceIntersection::Triangles;
+					for (photonEmitOrder = 0; photonEmitOrder < IM_ARRAYSIZE(PHOTON_EMIT_ORDER_NAMES); photonEmitOrder++)
+					{
+						float totalMs = 0.0f;
+						for (int run = 0; run < PHOTON_BENCHMARK_RUNS; run++)
+						{
+							photonTimer.Begin(true);
+							dispatchPhotons(intersection, photonRayCount);
+							photonTimer.End();
+							totalMs += photonTimer.Wait();
+						}
+						float averageMs = totalMs / PHOTON_BENCHMARK_RUNS;
+						char line[256];
+						snprintf(line, sizeof(line), "%s, %s: %.3f ms, %.1f Mphotons/s\n", accelerated ? "BVH" : "Brute force",
+								 PHOTON_EMIT_ORDER_NAMES[photonEmitOrder], averageMs, photonRayCount / (averageMs * 1000.0f));
+						photonBenchmarkResult += line;
+					}
+				}
+				useSceneBvh = prevUseSceneBvh;
+				photonEmitOrder = prevEmitOrder;
+				std::cout << photonBenchmarkResult;
+				causticMap.ResetAccumulation();
+			}
+
+			// anything that reset the map, from the light and photon settings to the region or a benchmark, drops the bake
+			if (causticMap.GetAccumulatedFrames() == 0)
+				holdBakedCaustics = false;
+			if (photonBake.IsActive())
+			{
+				photonBake.Step([&](unsigned int, unsigned int count)
+				{
+					dispatchPhotons(static_cast<SurfaceIntersection>(surfaceIntersection), count);
+				});
+				holdBakedCaustics = !photonBake.IsActive();
+			}
+			else if (!holdBakedCaustics)
+			{
+				photonTimer.Begin();
+				dispatchPhotons(static_cast<SurfaceIntersection>(surfaceIntersection), photonRayCount);
+				photonTimer.End();
+				photonTimer.Update();
+			}
+			if (causticEstimate == static_cast<int>(CausticEstimate::PhotonDensity))
+			{
+				photonHashTimer.Begin();
+				photonHashGrid.Build(2.0f * photonDensityRadius);
+				photonHashTimer.End();
+				photonHashTimer.Update();
+			}
+			if (denoiseCaustics)
+			{
+				causticDenoiseTimer.Begin();
+				causticDenoiser.BeginGuide(causticMap);
+				for (glm::mat4& copyMatrix : sceneCopyMatrices)
+					sceneCornellOriginal.Render(copyMatrix);
+				causticDenoiser.EndGuide();
+				causticDenoiser.Denoise(causticMap);
+				causticDenoiseTimer.End();
+				causticDenoiseTimer.Update();
+			}
+			glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+
+			Renderer::UseShader(ShaderMode::Point);
+			DEBUG_DPM.Render(false, lastPhotonCount);
+
+			if (holdBakedCaustics)
+			{
+				ImGui::Text("Photons: holding a bake of %u", photonBake.GetDoneWork());
+			}
+			else
+			{
+				// bake chunks are timed by the job, the per-frame timer only sees regular passes
+				float photonMs = photonBake.IsActive() ? photonBake.GetLastMilliseconds() : photonTimer.GetAverageMilliseconds();
+				ImGui::Text("Photons: %u in %.3f ms, %.1f Mphotons/s", lastPhotonCount, photonMs,
+							lastPhotonCount / (std::max(photonMs, 0.001f) * 1000.0f));
+			}
+			ImGui::Text("Caustics: %d frames accumulated", causticMap.GetAccumulatedFrames());
+			if (denoiseCaustics)
+			{
+				ImGui::Text("Caustic denoiser: %dx%d, %.3f ms", causticDenoiser.GetResolution(), causticDenoiser.GetResolution(),
+							causticDenoiseTimer.GetAverageMilliseconds());
+			}
+			if (useSceneHeightfield)
+			{
+				ImGui::Text("Receiver heightfield: %dx%d, built %u times", sceneHeightfield.GetResolution(), sceneHeightfield.GetResolution(),
+							sceneHeightfieldBuildCount);
+			}
+			if (causticEstimate == static_cast<int>(CausticEstimate::PhotonDensity))
+			{
+				ImGui::Text("Photon hash grid: %u slots for %u photons, built in %.3f ms", photonHashGrid.GetTableSize(),
+							photonHashGrid.GetCapacity(), photonHashTimer.GetAverageMilliseconds());
+			}
+			ImGui::Text("Water BVH: %u nodes, built in %.3f ms, refit %.3f ms", waterBvh.GetNodeCount(), waterBvh.GetBuildMilliseconds(),
+						waterBvhTimer.GetAverageMilliseconds());
+			const Bvh::BuildStats& bvhStats = sceneCornellOriginal.bvhStats;
+			ImGui::Text("Scene BVH: %u triangles, %u nodes, %u leaves, depth %u", bvhStats.triangleCount, bvhStats.nodeCount,
+						bvhStats.leafCount, bvhStats.maxDepth);
+			ImGui::Text("Scene BVH: SAH cost %.2f, built in %.2f ms", bvhStats.sahCost, bvhStats.buildMilliseconds);
+			const Bvh::BuildStats& instanceStats = photonInstances.GetStats();
+			ImGui::Text("Instances: %u, %u top-level nodes, built in %.3f ms", photonInstances.GetInstanceCount(), instanceStats.nodeCount,
+						instanceStats.buildMilliseconds);
+			if (!photonBenchmarkResult.empty())
+				ImGui::Text("%s", photonBenchmarkResult.c_str());
+		}
 
 		ImGui::End();
 		ImGui::Render();
@@ -13,12 +13,16 @@ std::vector<Shader> Renderer::shaders{};
 glm::vec3 Renderer::sceneBoundary{};
 
 glm::mat4 Renderer::P{ 0.1f };
+glm::mat4 Renderer::invP{ 1.0f };
+glm::vec2 Renderer::viewportSize{ 1.0f };
 glm::vec3 Renderer::cameraPos{ 0.0f, 5.0f, 15.0f };
 glm::vec3 Renderer::cameraUp{ 0.0f, 1.0f, 0.0f };
 glm::vec3 Renderer::cameraForward{ 0.0f, 0.0f, -1.0f };
 float Renderer::cameraPitch = 0.0f;
 float Renderer::cameraYaw = 180.0f;
 
+Light Renderer::light{};
+
 #define GL_SHADER_INCLUDE_ARB 0x8DAE
 typedef void (*NamedStringARBPtr)(GLenum, GLint, const char*, GLint, const char*);
 NamedStringARBPtr glNamedStringARB;
@@ -32,6 +36,8 @@ void Renderer::Init(float width, float height, glm::vec3 boundary)
 	glEnable(GL_DEPTH_TEST);
 	sceneBoundary = boundary;
 	P = glm::perspectiveFov(FOV, width, height, Z_NEAR, Z_FAR);
+	invP = glm::inverse(P);
+	viewportSize = glm::vec2{ width, height };
 
 	glNamedStringARB = reinterpret_cast<NamedStringARBPtr>(glfwGetProcAddress("glNamedStringARB"));
 	AddShaderIncludeDir("assets/shaders/include");
@@ -39,8 +45,28 @@ void Renderer::Init(float width, float height, glm::vec3 boundary)
 	shaders.push_back(Shader::CreateShaderVF("assets/shaders/pass.vert", "assets/shaders/pass.frag"));				// ShaderMode::PassThrough
 	shaders.push_back(Shader::CreateShaderVF("assets/shaders/point.vert", "assets/shaders/pass.frag"));				// ShaderMode::Point
 	shaders.push_back(Shader::CreateShaderVF("assets/shaders/phong.vert", "assets/shaders/phong.frag"));			// ShaderMode::Phong
+	shaders.push_back(Shader::CreateShaderVF("assets/shaders/phong.vert", "assets/shaders/phongPhotonDensity.frag"));	// ShaderMode::PhongPhotonDensity
 	shaders.push_back(Shader::CreateShaderVF("assets/shaders/surfaceDisplace.vert", "assets/shaders/phong.frag"));	// ShaderMode::SurfaceDisplacement
 	shaders.push_back(Shader::CreateShaderVF("assets/shaders/surfaceHeight.vert", "assets/shaders/phong.frag"));	// ShaderMode::SurfaceHeight
+	shaders.push_back(Shader::CreateShaderVF("assets/shaders/surfaceChunkDisplace.vert", "assets/shaders/phong.frag"));	// ShaderMode::SurfaceChunkDisplacement
+	shaders.push_back(Shader::CreateShaderVF("assets/shaders/surfaceChunkHeight.vert", "assets/shaders/phong.frag"));	// ShaderMode::SurfaceChunkHeight
+	shaders.push_back(Shader::CreateShaderVF("assets/shaders/surfaceGridDisplace.vert", "assets/shaders/phong.frag"));	// ShaderMode::SurfaceGridDisplacement
+	shaders.push_back(Shader::CreateShaderVF("assets/shaders/surfaceGridHeight.vert", "assets/shaders/phong.frag"));	// ShaderMode::SurfaceGridHeight
+	shaders.push_back(Shader::CreateShaderVF("assets/shaders/surfaceClipmapDisplace.vert", "assets/shaders/phong.frag"));	// ShaderMode::SurfaceClipmapDisplacement
+	shaders.push_back(Shader::CreateShaderVF("assets/shaders/surfaceClipmapHeight.vert", "assets/shaders/phong.frag"));	// ShaderMode::SurfaceClipmapHeight
+	shaders.push_back(Shader::CreateShaderVF("assets/shaders/surfaceProjectedDisplace.vert", "assets/shaders/phong.frag"));	// ShaderMode::SurfaceProjectedDisplacement
+	shaders.push_back(Shader::CreateShaderVF("assets/shaders/surfaceProjectedHeight.vert", "assets/shaders/phong.frag"));	// ShaderMode::SurfaceProjectedHeight
+	shaders.push_back(Shader::CreateShaderVF("assets/shaders/surfaceCulledDisplace.vert", "assets/shaders/phong.frag"));	// ShaderMode::SurfaceCulledDisplacement
+	shaders.push_back(Shader::CreateShaderVF("assets/shaders/surfaceCulledHeight.vert", "assets/shaders/phong.frag"));	// ShaderMode::SurfaceCulledHeight
+	shaders.push_back(Shader::CreateShaderVF("assets/shaders/surfaceBuffered.vert", "assets/shaders/phong.frag"));	// ShaderMode::SurfaceBuffered
+	shaders.push_back(Shader::CreateShaderVF("assets/shaders/surfaceCulledBuffered.vert", "assets/shaders/phong.frag"));	// ShaderMode::SurfaceCulledBuffered
+	shaders.push_back(Shader::CreateShaderVTF("assets/shaders/surfaceTessellated.vert", "assets/shaders/surfaceTessellated.tesc",
+											  "assets/shaders/surfaceTessellatedDisplace.tese", "assets/shaders/phong.frag"));	// ShaderMode::SurfaceTessellatedDisplacement
+	shaders.push_back(Shader::CreateShaderVTF("assets/shaders/surfaceTessellated.vert", "assets/shaders/surfaceTessellated.tesc",
+											  "assets/shaders/surfaceTessellatedHeight.tese", "assets/shaders/phong.frag"));	// ShaderMode::SurfaceTessellatedHeight
+	shaders.push_back(Shader::CreateShaderVGF("assets/shaders/causticRaster.vert", "assets/shaders/causticRaster.geom",
+											  "assets/shaders/causticRaster.frag"));											// ShaderMode::CausticRaster
+	shaders.push_back(Shader::CreateShaderVF("assets/shaders/phong.vert", "assets/shaders/causticGuide.frag"));		// ShaderMode::CausticGuide
 	shaders.push_back(Shader::CreateShaderCompute("assets/shaders/currentFreqWave.comp"));							// ShaderMode::ComputeFreqWave
 	shaders.push_back(Shader::CreateShaderCompute("assets/shaders/ifftX.comp"));									// ShaderMode::ComputeIFFTX
 	shaders.push_back(Shader::CreateShaderCompute("assets/shaders/ifftY.comp"));									// ShaderMode::ComputeIFFTY
@@ -49,7 +75,26 @@ void Renderer::Init(float width, float height, glm::vec3 boundary)
 	shaders.push_back(Shader::CreateShaderCompute("assets/shaders/normalSobel.comp"));								// ShaderMode::ComputeNormalSobel
 	shaders.push_back(Shader::CreateShaderCompute("assets/shaders/gerstner.comp"));									// ShaderMode::ComputeGerstner
 	shaders.push_back(Shader::CreateShaderCompute("assets/shaders/surfaceBoundingBoxes.comp"));						// ShaderMode::ComputeSurfaceBoundingBoxes
-	shaders.push_back(Shader::CreateShaderCompute("assets/shaders/photonMappingCastRays.comp"));					// ShaderMode::ComputePhotonMappingCastRays
+	shaders.push_back(Shader::CreateShaderCompute("assets/shaders/surfaceCulling.comp"));							// ShaderMode::ComputeSurfaceCulling
+	shaders.push_back(Shader::CreateShaderCompute("assets/shaders/heightPyramid.comp"));							// ShaderMode::ComputeHeightPyramid
+	shaders.push_back(Shader::CreateShaderCompute("assets/shaders/surfaceDisplaceVertices.comp"));					// ShaderMode::ComputeSurfaceDisplaceVertices
+	shaders.push_back(Shader::CreateShaderCompute("assets/shaders/lbvhMorton.comp"));								// ShaderMode::ComputeLbvhMorton
+	shaders.push_back(Shader::CreateShaderCompute("assets/shaders/radixHistogram.comp"));							// ShaderMode::ComputeRadixHistogram
+	shaders.push_back(Shader::CreateShaderCompute("assets/shaders/prefixScan.comp"));								// ShaderMode::ComputePrefixScan
+	shaders.push_back(Shader::CreateShaderCompute("assets/shaders/prefixScanAdd.comp"));							// ShaderMode::ComputePrefixScanAdd
+	shaders.push_back(Shader::CreateShaderCompute("assets/shaders/radixScatter.comp"));								// ShaderMode::ComputeRadixScatter
+	shaders.push_back(Shader::CreateShaderCompute("assets/shaders/lbvhHierarchy.comp"));							// ShaderMode::ComputeLbvhHierarchy
+	shaders.push_back(Shader::CreateShaderCompute("assets/shaders/lbvhRefit.comp"));								// ShaderMode::ComputeLbvhRefit
+	shaders.push_back(Shader::CreateShaderCompute("assets/shaders/tlasRefit.comp"));								// ShaderMode::ComputeTlasRefit
+	shaders.push_back(Shader::CreateShaderCompute("assets/shaders/causticResolve.comp"));							// ShaderMode::ComputeCausticResolve
+	shaders.push_back(Shader::CreateShaderCompute("assets/shaders/photonGenerate.comp"));							// ShaderMode::ComputePhotonGenerate
+	shaders.push_back(Shader::CreateShaderCompute("assets/shaders/photonIntersect.comp"));							// ShaderMode::ComputePhotonIntersect
+	shaders.push_back(Shader::CreateShaderCompute("assets/shaders/photonShade.comp"));								// ShaderMode::ComputePhotonShade
+	shaders.push_back(Shader::CreateShaderCompute("assets/shaders/photonPrepareDispatch.comp"));					// ShaderMode::ComputePhotonPrepareDispatch
+	shaders.push_back(Shader::CreateShaderCompute("assets/shaders/photonHashCount.comp"));							// ShaderMode::ComputePhotonHashCount
+	shaders.push_back(Shader::CreateShaderCompute("assets/shaders/photonHashScatter.comp"));						// ShaderMode::ComputePhotonHashScatter
+	shaders.push_back(Shader::CreateShaderCompute("assets/shaders/causticTemporal.comp"));							// ShaderMode::ComputeCausticTemporal
+	shaders.push_back(Shader::CreateShaderCompute("assets/shaders/causticAtrous.comp"));							// ShaderMode::ComputeCausticAtrous
 	UseShader(ShaderMode::PassThrough);
 }
 
@@ -58,10 +103,13 @@ void Renderer::UseShader(ShaderMode mode)
 	current = &shaders[static_cast<int>(mode)];
 	current->Use();
 	SetMat4("P", P);
+	SetMat4("invP", invP);
+	SetVec2("viewportSize", viewportSize.x, viewportSize.y);
 	glm::mat4 V = glm::lookAt(cameraPos, cameraPos + cameraForward, cameraUp); // TODO: cache
 	glm::mat4 invV = glm::inverse(V);
 	SetMat4("V", V);
 	SetMat4("invV", invV);
+	light.Set();
 }
 
 void Renderer::TranslateCamera(float forward, float right, float up)
@@ -84,6 +132,16 @@ void Renderer::RotateCamera(float pitch, float yaw)
 	cameraForward = glm::normalize(cameraForward);
 }
 
+glm::vec3 Renderer::GetCameraPosition()
+{
+	return cameraPos;
+}
+
+float Renderer::GetFarPlane()
+{
+	return Z_FAR;
+}
+
 void Renderer::SetTexture2D(GLenum textureUnit, const char* name, GLuint texture)
 {
 	glActiveTexture(textureUnit);
@@ -91,9 +149,9 @@ void Renderer::SetTexture2D(GLenum textureUnit, const char* name, GLuint texture
 	SetInt(name, textureUnit - GL_TEXTURE0);
 }
 
-void Renderer::SetImage(GLuint imageUnit, const char* name, GLuint image, GLenum access, GLenum format)
+void Renderer::SetImage(GLuint imageUnit, const char* name, GLuint image, GLenum access, GLenum format, GLint level)
 {
-	glBindImageTexture(imageUnit, image, 0, true, 0, access, format);
+	glBindImageTexture(imageUnit, image, level, true, 0, access, format);
 	Renderer::SetInt(name, imageUnit);
 }
 
@@ -112,6 +170,11 @@ void Renderer::SetFloat(const char* name, float value)
 	current->SetFloat(name, value);
 }
 
+void Renderer::SetVec2(const char* name, float x, float y)
+{
+	current->SetVec2(name, x, y);
+}
+
 void Renderer::SetVec3(const char* name, float x, float y, float z)
 {
 	current->SetVec3(name, x, y, z);
@@ -151,6 +214,20 @@ GLuint Renderer::CreateTexture2D(GLsizei width, GLsizei height, GLint internalFo
 	return texture;
 }
 
+GLuint Renderer::CreateTextureStorage2D(GLsizei width, GLsizei height, GLsizei levels, GLenum internalFormat,
+										GLint filterType, GLint texWrapType)
+{
+	GLuint texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexStorage2D(GL_TEXTURE_2D, levels, internalFormat, width, height);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filterType);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filterType);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, texWrapType);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, texWrapType);
+	return texture;
+}
+
 void Renderer::SubTexture2DData(GLuint texture, GLint xOffset, GLint yOffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels)
 {
 	glBindTexture(GL_TEXTURE_2D, texture);
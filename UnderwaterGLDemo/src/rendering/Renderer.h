@@ -5,6 +5,7 @@
 
 #include <glm/glm.hpp>
 
+#include "Light.h"
 #include "Shader.h"
 
 enum class ShaderMode
@@ -12,8 +13,25 @@ enum class ShaderMode
 	PassThrough,
 	Point,
 	Phong,
+	PhongPhotonDensity,
 	SurfaceDisplacement,
 	SurfaceHeight,
+	SurfaceChunkDisplacement,
+	SurfaceChunkHeight,
+	SurfaceGridDisplacement,
+	SurfaceGridHeight,
+	SurfaceClipmapDisplacement,
+	SurfaceClipmapHeight,
+	SurfaceProjectedDisplacement,
+	SurfaceProjectedHeight,
+	SurfaceCulledDisplacement,
+	SurfaceCulledHeight,
+	SurfaceBuffered,
+	SurfaceCulledBuffered,
+	SurfaceTessellatedDisplacement,
+	SurfaceTessellatedHeight,
+	CausticRaster,
+	CausticGuide,
 	ComputeFreqWave,
 	ComputeIFFTX,
 	ComputeIFFTY,
@@ -22,7 +40,26 @@ enum class ShaderMode
 	ComputeNormalSobel,
 	ComputeGerstner,
 	ComputeSurfaceBoundingBoxes,
-	ComputePhotonMappingCastRays
+	ComputeSurfaceCulling,
+	ComputeHeightPyramid,
+	ComputeSurfaceDisplaceVertices,
+	ComputeLbvhMorton,
+	ComputeRadixHistogram,
+	ComputePrefixScan,
+	ComputePrefixScanAdd,
+	ComputeRadixScatter,
+	ComputeLbvhHierarchy,
+	ComputeLbvhRefit,
+	ComputeTlasRefit,
+	ComputeCausticResolve,
+	ComputePhotonGenerate,
+	ComputePhotonIntersect,
+	ComputePhotonShade,
+	ComputePhotonPrepareDispatch,
+	ComputePhotonHashCount,
+	ComputePhotonHashScatter,
+	ComputeCausticTemporal,
+	ComputeCausticAtrous
 };
 
 class Renderer
@@ -32,10 +69,11 @@ public:
 	static void UseShader(ShaderMode mode);
 
 	static void SetTexture2D(GLenum textureUnit, const char* name, GLuint texture);
-	static void SetImage(GLuint imageUnit, const char* name, GLuint image, GLenum access, GLenum format);
+	static void SetImage(GLuint imageUnit, const char* name, GLuint image, GLenum access, GLenum format, GLint level = 0);
 	static void SetInt(const char* name, int value);
 	static void SetUint(const char* name, unsigned int value);
 	static void SetFloat(const char* name, float value);
+	static void SetVec2(const char* name, float x, float y);
 	static void SetVec3(const char* name, float x, float y, float z);
 	static void SetVec3(const char* name, glm::vec3& vec);
 	static void SetVec4(const char* name, float x, float y, float z, float w);
@@ -44,9 +82,17 @@ public:
 
 	static void TranslateCamera(float forward, float right, float up);
 	static void RotateCamera(float pitch, float yaw);
+	static glm::vec3 GetCameraPosition();
+	static float GetFarPlane();
+
+	// applied to every shader on use, like the camera
+	static void SetLight(const Light& newLight);
 
 	static GLuint CreateTexture2D(GLsizei width, GLsizei height, GLint internalFormat, GLenum format, GLenum type, const void* pixels,
 								  GLint filterType = GL_NEAREST, GLint texWrapType = GL_CLAMP_TO_EDGE);
+	// immutable storage with a full mip chain, needed for binding single levels as images
+	static GLuint CreateTextureStorage2D(GLsizei width, GLsizei height, GLsizei levels, GLenum internalFormat,
+										 GLint filterType = GL_NEAREST, GLint texWrapType = GL_REPEAT);
 	static void SubTexture2DData(GLuint texture, GLint xOffset, GLint yOffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels);
 
 private:
@@ -57,10 +103,13 @@ private:
 
 	static glm::vec3 sceneBoundary;
 
-	static glm::mat4 P;
+	static glm::mat4 P, invP;
+	static glm::vec2 viewportSize;
 	static glm::vec3 cameraPos;
 	static glm::vec3 cameraUp;
 	static glm::vec3 cameraForward;
 	static float cameraPitch;
 	static float cameraYaw;
+
+	static Light light;
 };
\ No newline at end of file
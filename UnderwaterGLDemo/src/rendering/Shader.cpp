@@ -52,6 +52,27 @@ Shader Shader::CreateShaderVGF(const char* vertPath, const char* geomPath, const
 	return Shader{ id };
 }
 
+Shader Shader::CreateShaderVTF(const char* vertPath, const char* tescPath, const char* tesePath, const char* fragPath)
+{
+	int success;
+	char infoLog[INFO_LOG_SIZE];
+	int id = glCreateProgram();
+
+	int vertShader = AttachShader(id, vertPath, GL_VERTEX_SHADER, success, infoLog);
+	int tescShader = AttachShader(id, tescPath, GL_TESS_CONTROL_SHADER, success, infoLog);
+	int teseShader = AttachShader(id, tesePath, GL_TESS_EVALUATION_SHADER, success, infoLog);
+	int fragShader = AttachShader(id, fragPath, GL_FRAGMENT_SHADER, success, infoLog);
+
+	LinkProgram(id, success, infoLog);
+
+	glDeleteShader(vertShader);
+	glDeleteShader(tescShader);
+	glDeleteShader(teseShader);
+	glDeleteShader(fragShader);
+
+	return Shader{ id };
+}
+
 Shader Shader::CreateShaderCompute(const char* compPath)
 {
 	int success;
@@ -89,6 +110,11 @@ void Shader::SetFloat(const char* name, float value)
 	glUniform1f(glGetUniformLocation(ID, name), value);
 }
 
+void Shader::SetVec2(const char* name, float x, float y)
+{
+	glUniform2f(glGetUniformLocation(ID, name), x, y);
+}
+
 void Shader::SetVec3(const char* name, float x, float y, float z)
 {
 	glUniform3f(glGetUniformLocation(ID, name), x, y, z);
@@ -10,12 +10,14 @@ public:
 
 	static Shader CreateShaderVF(const char* vertPath, const char* fragPath);
 	static Shader CreateShaderVGF(const char* vertPath, const char* geomPath, const char* fragPath);
+	static Shader CreateShaderVTF(const char* vertPath, const char* tescPath, const char* tesePath, const char* fragPath);
 	static Shader CreateShaderCompute(const char* compPath);
 
 	void Use();
 	void SetInt(const char* name, int value);
 	void SetUint(const char* name, unsigned int value);
 	void SetFloat(const char* name, float value);
+	void SetVec2(const char* name, float x, float y);
 	void SetVec3(const char* name, float x, float y, float z);
 	void SetVec3(const char* name, glm::vec3& vec);
 	void SetVec4(const char* name, float x, float y, float z, float w);